@@ -0,0 +1,127 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(_MSC_VER)
+    #include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+    #include <cpuid.h>
+#endif
+
+// ordered, every level implies the ones below it
+enum simd_level_e
+{
+    simd_scalar = 0,
+    simd_sse42 = 1,    // SSSE3 + SSE4.1 + SSE4.2
+    simd_avx2 = 2,
+    simd_avx512 = 3    // AVX-512F + BW
+};
+
+static const char *const simd_level_names[] = {"scalar", "sse42", "avx2", "avx512"};
+
+// shared by cv and dsa, so it lives in neither; functions are inline for the same reason
+
+inline void cpu_id(uint32_t leaf, uint32_t sub_leaf, uint32_t regs[4])
+{
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuidex(info, (int)leaf, (int)sub_leaf);
+    for (int i = 0; i < 4; i++)
+    {
+        regs[i] = (uint32_t)info[i];
+    }
+#elif defined(__x86_64__) || defined(__i386__)
+    __cpuid_count(leaf, sub_leaf, regs[0], regs[1], regs[2], regs[3]);
+#else
+    regs[0] = regs[1] = regs[2] = regs[3] = 0;
+#endif
+}
+
+// register state the OS saves on context switch, AVX needs YMM and AVX-512 needs ZMM too
+inline uint64_t cpu_xcr0()
+{
+#if defined(_MSC_VER)
+    return _xgetbv(0);
+#elif defined(__x86_64__) || defined(__i386__)
+    uint32_t eax, edx;
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return ((uint64_t)edx << 32) | eax;
+#else
+    return 0;
+#endif
+}
+
+inline simd_level_e detect_simd_level()
+{
+    uint32_t regs[4];
+    cpu_id(0, 0, regs);
+    uint32_t max_leaf = regs[0];
+    if (max_leaf < 1)
+    {
+        return simd_scalar;
+    }
+
+    cpu_id(1, 0, regs);
+    uint32_t ecx1 = regs[2];
+    bool ssse3 = (ecx1 >> 9) & 1;
+    bool sse41 = (ecx1 >> 19) & 1;
+    bool sse42 = (ecx1 >> 20) & 1;
+    bool osxsave = (ecx1 >> 27) & 1;
+    bool avx = (ecx1 >> 28) & 1;
+    if (!(ssse3 && sse41 && sse42))
+    {
+        return simd_scalar;
+    }
+    if (!(osxsave && avx) || (max_leaf < 7))
+    {
+        return simd_sse42;
+    }
+
+    uint64_t xcr0 = cpu_xcr0();
+    cpu_id(7, 0, regs);
+    uint32_t ebx7 = regs[1];
+    bool avx2 = ((ebx7 >> 5) & 1) && ((xcr0 & 0x6) == 0x6);
+    bool avx512 = ((ebx7 >> 16) & 1) && ((ebx7 >> 30) & 1) && ((xcr0 & 0xE6) == 0xE6);
+    if (!avx2)
+    {
+        return simd_sse42;
+    }
+    return avx512 ? simd_avx512 : simd_avx2;
+}
+
+// CV_SIMD_LEVEL=scalar|sse42|avx2|avx512 lowers the level for testing and benchmarking,
+// a level the cpu does not have is clamped to the detected one
+inline simd_level_e select_simd_level()
+{
+    simd_level_e level = detect_simd_level();
+    const char *env = getenv("CV_SIMD_LEVEL");
+    if ((env == NULL) || (env[0] == '\0'))
+    {
+        return level;
+    }
+
+    for (int i = simd_scalar; i <= simd_avx512; i++)
+    {
+        if (strcmp(env, simd_level_names[i]) == 0)
+        {
+            if (i > level)
+            {
+                fprintf(stderr, "CV_SIMD_LEVEL=%s not supported, using %s\n", env, simd_level_names[level]);
+                return level;
+            }
+            return (simd_level_e)i;
+        }
+    }
+    fprintf(stderr, "CV_SIMD_LEVEL=%s unknown, using %s\n", env, simd_level_names[level]);
+    return level;
+}
+
+// detected once, on first use
+inline simd_level_e simd_level()
+{
+    static const simd_level_e level = select_simd_level();
+    return level;
+}
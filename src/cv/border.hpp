@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+
+#include "enums.hpp"
+
+// map an out-of-range coordinate onto [0, size) following the edge mode used by convolve(),
+// returns -1 for zero padding
+int border_index(int pos, int size, edge_e edge)
+{
+    if ((pos >= 0) && (pos < size))
+    {
+        return pos;
+    }
+
+    if (edge == clamp)
+    {
+        return (pos < 0) ? 0 : (size - 1);
+    }
+    else if (edge == mirror)
+    {
+        // reflect repeatedly so kernels wider than the image stay in range
+        while ((pos < 0) || (pos >= size))
+        {
+            if (pos < 0)
+            {
+                pos = -pos;
+            }
+            else
+            {
+                pos = size - (pos - size) - 1;
+            }
+
+            if (size == 1)
+            {
+                return 0;
+            }
+        }
+        return pos;
+    }
+
+    return -1;
+}
+
+// copy src[0, size) into dst with pad_left / pad_right border pixels on each side
+void pad_line(const uint8_t *src, int size, uint8_t *dst, int pad_left, int pad_right, edge_e edge)
+{
+    for (int i = -pad_left; i < 0; i++)
+    {
+        int pos = border_index(i, size, edge);
+        dst[i + pad_left] = (pos < 0) ? 0 : src[pos];
+    }
+    for (int i = 0; i < size; i++)
+    {
+        dst[i + pad_left] = src[i];
+    }
+    for (int i = size; i < size + pad_right; i++)
+    {
+        int pos = border_index(i, size, edge);
+        dst[i + pad_left] = (pos < 0) ? 0 : src[pos];
+    }
+}
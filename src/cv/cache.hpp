@@ -0,0 +1,312 @@
+#pragma once
+
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#ifdef _WIN32
+    #include <direct.h>
+#else
+    #include <sys/stat.h>
+#endif
+
+#include "parallel.hpp"
+#include "pgm.hpp"
+#include "view.hpp"
+
+#define CACHE_MULTIPLIER  0x9E3779B97F4A7C15ULL
+#define CACHE_MAX_BYTES   (256ULL << 20)
+
+// stage outputs on disk named by a 64-bit key; a stage key is its input key mixed with the
+// stage name and every parameter, so an unchanged chain of stages maps to the same files and
+// the input pixels are hashed once at the head of the pipeline
+
+uint64_t cache_mix(uint64_t hash, uint64_t value)
+{
+    hash = (hash ^ value) * CACHE_MULTIPLIER;
+    return hash ^ (hash >> 29);
+}
+
+// four independent lanes of 8 bytes so the multiplies overlap
+uint64_t cache_hash(const void *data, size_t size, uint64_t seed)
+{
+    const uint8_t *ptr = reinterpret_cast<const uint8_t *>(data);
+    uint64_t lane[4] = {seed, seed + 1, seed + 2, seed + 3};
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32)
+    {
+        for (int l = 0; l < 4; l++)
+        {
+            uint64_t word;
+            memcpy(&word, ptr + i + 8 * l, sizeof(word));
+            lane[l] = cache_mix(lane[l], word);
+        }
+    }
+    for (; i + 8 <= size; i += 8)
+    {
+        uint64_t word;
+        memcpy(&word, ptr + i, sizeof(word));
+        lane[0] = cache_mix(lane[0], word);
+    }
+    uint64_t tail = 0;
+    memcpy(&tail, ptr + i, size - i);
+
+    uint64_t hash = cache_mix(size, tail);
+    for (int l = 0; l < 4; l++)
+    {
+        hash = cache_mix(hash, lane[l]);
+    }
+    return hash;
+}
+
+// rows are hashed in parallel and folded in order, so the key does not depend on the thread count
+uint64_t image_key(image_view_t img)
+{
+    std::vector<uint64_t> row_hash(img.height());
+    parallel_rows(img.height(), [&](uint32_t y0, uint32_t y1) {
+        for (uint32_t y = y0; y < y1; y++)
+        {
+            row_hash[y] = cache_hash(img.row(y), img.width(), y);
+        }
+    });
+
+    uint64_t hash = cache_mix(cache_mix(0, img.width()), img.height());
+    for (uint32_t y = 0; y < img.height(); y++)
+    {
+        hash = cache_mix(hash, row_hash[y]);
+    }
+    return hash;
+}
+
+// parameters are folded in with cache_mix(key, value) after this
+uint64_t stage_key(uint64_t input_key, const char *stage)
+{
+    return cache_hash(stage, strlen(stage), input_key);
+}
+
+// convolution stages: weights, size and divisor all change the output
+uint64_t kernel_key(uint64_t key, const int8_t *kernel, uint32_t k_size, int16_t div_factor)
+{
+    key = cache_hash(kernel, k_size * k_size, key);
+    return cache_mix(cache_mix(key, k_size), (uint64_t)(int64_t)div_factor);
+}
+
+typedef struct
+{
+    uint64_t key;
+    uint64_t bytes;
+} cache_entry_t;
+
+// least recently used entries are dropped once the files add up to more than max_bytes; the
+// order survives between runs in an index file, oldest entry first
+class stage_cache_t
+{
+public:
+    // an empty dir disables the cache: every lookup misses and nothing is written
+    stage_cache_t(const std::string &dir, uint64_t max_bytes)
+    {
+        this->_dir = dir;
+        this->_max_bytes = max_bytes;
+        this->_bytes = 0;
+        this->_hits = 0;
+        this->_misses = 0;
+        this->_evictions = 0;
+        if (dir.empty())
+        {
+            return;
+        }
+#ifdef _WIN32
+        _mkdir(dir.c_str());
+#else
+        mkdir(dir.c_str(), 0755);
+#endif
+        this->load_index();
+    }
+
+    ~stage_cache_t() { this->save_index(); }
+
+    bool fetch(uint64_t key, pgm_t &img)
+    {
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        std::unordered_map<uint64_t, std::list<cache_entry_t>::iterator>::iterator it = this->_lookup.find(key);
+        if (it == this->_lookup.end())
+        {
+            this->_misses++;
+            return false;
+        }
+        if (!read_entry(this->path(key), img))
+        {
+            // removed or damaged behind our back, forget it
+            this->_bytes -= it->second->bytes;
+            this->_lru.erase(it->second);
+            this->_lookup.erase(it);
+            this->_misses++;
+            return false;
+        }
+
+        this->_lru.splice(this->_lru.begin(), this->_lru, it->second);
+        this->_hits++;
+        return true;
+    }
+
+    void store(uint64_t key, pgm_t &img)
+    {
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        if (this->_dir.empty() || (this->_lookup.find(key) != this->_lookup.end()))
+        {
+            return;
+        }
+        uint64_t bytes = (uint64_t)img.width() * img.height();
+        if ((bytes > this->_max_bytes) || !write_entry(this->path(key), img))
+        {
+            return;
+        }
+
+        cache_entry_t entry = {key, bytes};
+        this->_lru.push_front(entry);
+        this->_lookup[key] = this->_lru.begin();
+        this->_bytes += bytes;
+        while (this->_bytes > this->_max_bytes)
+        {
+            const cache_entry_t &oldest = this->_lru.back();
+            remove(this->path(oldest.key).c_str());
+            this->_bytes -= oldest.bytes;
+            this->_lookup.erase(oldest.key);
+            this->_lru.pop_back();
+            this->_evictions++;
+        }
+        this->save_index_locked();
+    }
+
+    // dst from the cache, or compute() fills dst and the result is stored; true on a hit
+    template <typename F>
+    bool run(uint64_t key, pgm_t &dst, F compute)
+    {
+        if (this->fetch(key, dst))
+        {
+            return true;
+        }
+        compute();
+        this->store(key, dst);
+        return false;
+    }
+
+    void save_index()
+    {
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        this->save_index_locked();
+    }
+
+    uint64_t hits() { return this->_hits; }
+    uint64_t misses() { return this->_misses; }
+    uint64_t evictions() { return this->_evictions; }
+    uint64_t bytes() { return this->_bytes; }
+
+private:
+    std::string path(uint64_t key)
+    {
+        char name[32];
+        snprintf(name, sizeof(name), "/%016" PRIx64 ".pgm", key);
+        return this->_dir + name;
+    }
+
+    // entries are P5 files, so anything in the cache can be opened as an image
+    static bool read_entry(const std::string &path, pgm_t &img)
+    {
+        FILE *fp = fopen(path.c_str(), "rb");
+        if (fp == NULL)
+        {
+            return false;
+        }
+        uint32_t width, height, max_gray;
+        bool ok = (fscanf(fp, "P5 %u %u %u", &width, &height, &max_gray) == 3) && (fgetc(fp) != EOF) &&
+                  img.reshape(width, height) &&
+                  (fread(img.ptr(), 1, (size_t)width * height, fp) == (size_t)width * height);
+        fclose(fp);
+        return ok;
+    }
+
+    // written under a temporary name and renamed, so a reader never sees half a file
+    static bool write_entry(const std::string &path, pgm_t &img)
+    {
+        std::string temp = path + ".tmp";
+        FILE *fp = fopen(temp.c_str(), "wb");
+        if (fp == NULL)
+        {
+            return false;
+        }
+        size_t size = (size_t)img.width() * img.height();
+        bool ok = (fprintf(fp, "P5\n%u %u\n%u\n", img.width(), img.height(), img.max_gray()) > 0) &&
+                  (fwrite(img.ptr(), 1, size, fp) == size);
+        ok &= (fclose(fp) == 0);
+#ifdef _WIN32
+        remove(path.c_str());    // rename does not replace on windows
+#endif
+        if (!ok || (rename(temp.c_str(), path.c_str()) != 0))
+        {
+            remove(temp.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    void load_index()
+    {
+        FILE *fp = fopen((this->_dir + "/index.txt").c_str(), "r");
+        if (fp == NULL)
+        {
+            return;
+        }
+        cache_entry_t entry;
+        while (fscanf(fp, "%" SCNx64 " %" SCNu64, &entry.key, &entry.bytes) == 2)
+        {
+            if (this->_lookup.find(entry.key) != this->_lookup.end())
+            {
+                continue;
+            }
+            this->_lru.push_front(entry);
+            this->_lookup[entry.key] = this->_lru.begin();
+            this->_bytes += entry.bytes;
+        }
+        fclose(fp);
+    }
+
+    void save_index_locked()
+    {
+        if (this->_dir.empty())
+        {
+            return;
+        }
+        std::string index = this->_dir + "/index.txt";
+        std::string temp = index + ".tmp";
+        FILE *fp = fopen(temp.c_str(), "w");
+        if (fp == NULL)
+        {
+            return;
+        }
+        for (std::list<cache_entry_t>::reverse_iterator it = this->_lru.rbegin(); it != this->_lru.rend(); ++it)
+        {
+            fprintf(fp, "%016" PRIx64 " %" PRIu64 "\n", it->key, it->bytes);
+        }
+        fclose(fp);
+#ifdef _WIN32
+        remove(index.c_str());
+#endif
+        rename(temp.c_str(), index.c_str());
+    }
+
+    std::string _dir;
+    uint64_t _max_bytes;
+    uint64_t _bytes;
+    uint64_t _hits;
+    uint64_t _misses;
+    uint64_t _evictions;
+    std::list<cache_entry_t> _lru;    // most recently used first
+    std::unordered_map<uint64_t, std::list<cache_entry_t>::iterator> _lookup;
+    std::mutex _mutex;
+};
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "dispatch.hpp"
+#include "enums.hpp"
+#include "parallel.hpp"
+#include "pgm.hpp"
+#include "view.hpp"
+
+// rgb bytes read per step of read_gray
+#define COLOR_CHUNK_BYTES (1U << 20)
+
+// luma weights in Q15, each row sums to 2^15 so white stays 255
+static const uint16_t gray_weights[2][3] = {
+    {9798, 19235, 3735},    // BT.601: 0.299, 0.587, 0.114
+    {6966, 23436, 2366}     // BT.709: 0.2126, 0.7152, 0.0722
+};
+
+// interleaved rgb rows (3 * width bytes used, rgb_stride bytes apart) to the gray image's size
+void rgb_to_gray(const uint8_t *rgb, uint32_t rgb_stride, image_view_t gray_img, gray_weights_e weights)
+{
+    const simd_kernels_t &kernels = simd_kernels();
+    parallel_rows(gray_img.height(), [&](uint32_t y0, uint32_t y1) {
+        for (uint32_t y = y0; y < y1; y++)
+        {
+            kernels.rgb_to_gray_row(rgb + (size_t)y * rgb_stride, gray_img.row(y), gray_img.width(),
+                                    gray_weights[weights]);
+        }
+    });
+}
+
+// interleaved rgb to one plane per channel, all planes the same size
+void rgb_to_planar(const uint8_t *rgb, uint32_t rgb_stride, image_view_t r_img, image_view_t g_img,
+                   image_view_t b_img)
+{
+    assert((g_img.width() == r_img.width()) && (b_img.width() == r_img.width()));
+    assert((g_img.height() == r_img.height()) && (b_img.height() == r_img.height()));
+
+    const simd_kernels_t &kernels = simd_kernels();
+    parallel_rows(r_img.height(), [&](uint32_t y0, uint32_t y1) {
+        for (uint32_t y = y0; y < y1; y++)
+        {
+            kernels.deinterleave_rgb_row(rgb + (size_t)y * rgb_stride, r_img.row(y), g_img.row(y), b_img.row(y),
+                                         r_img.width());
+        }
+    });
+}
+
+void planar_to_rgb(image_view_t r_img, image_view_t g_img, image_view_t b_img, uint8_t *rgb, uint32_t rgb_stride)
+{
+    assert((g_img.width() == r_img.width()) && (b_img.width() == r_img.width()));
+    assert((g_img.height() == r_img.height()) && (b_img.height() == r_img.height()));
+
+    const simd_kernels_t &kernels = simd_kernels();
+    parallel_rows(r_img.height(), [&](uint32_t y0, uint32_t y1) {
+        for (uint32_t y = y0; y < y1; y++)
+        {
+            kernels.interleave_rgb_row(r_img.row(y), g_img.row(y), b_img.row(y), rgb + (size_t)y * rgb_stride,
+                                       r_img.width());
+        }
+    });
+}
+
+// next header number of a netpbm file, skipping whitespace and '#' comments; the single
+// delimiter after the digits is consumed too
+static bool netpbm_read_uint(FILE *fp, uint32_t &val)
+{
+    int c = fgetc(fp);
+    while ((c != EOF) && (isspace(c) || (c == '#')))
+    {
+        if (c == '#')
+        {
+            while ((c != EOF) && (c != '\n'))
+            {
+                c = fgetc(fp);
+            }
+        }
+        c = fgetc(fp);
+    }
+    if ((c == EOF) || !isdigit(c))
+    {
+        return false;
+    }
+
+    val = 0;
+    while ((c != EOF) && isdigit(c))
+    {
+        val = val * 10 + (c - '0');
+        c = fgetc(fp);
+    }
+    return true;
+}
+
+// P5 or P6 into gray; P6 goes through a buffer of COLOR_CHUNK_BYTES converted in parallel as
+// it is read, so the full rgb image is never held in memory
+bool read_gray(const std::string &filename, pgm_t &gray, gray_weights_e weights = bt601)
+{
+    FILE *fp = fopen(filename.c_str(), "rb");
+    if (fp == NULL)
+    {
+        return false;
+    }
+
+    char magic[2];
+    uint32_t width, height, max_gray;
+    bool ok = (fread(magic, 1, 2, fp) == 2) && (magic[0] == 'P') && ((magic[1] == '5') || (magic[1] == '6')) &&
+              netpbm_read_uint(fp, width) && netpbm_read_uint(fp, height) && netpbm_read_uint(fp, max_gray) &&
+              (max_gray < 256) && (width > 0) && (height > 0) && (width <= UINT32_MAX / 3);
+    if (!ok || !gray.reshape(width, height))
+    {
+        fclose(fp);
+        return false;
+    }
+
+    if (magic[1] == '5')
+    {
+        ok = (fread(gray.ptr(), 1, (size_t)width * height, fp) == (size_t)width * height);
+        fclose(fp);
+        return ok;
+    }
+
+    image_view_t gray_img(gray);
+    uint32_t rgb_stride = 3 * width;
+    uint32_t chunk_rows = std::max(1u, COLOR_CHUNK_BYTES / rgb_stride);
+    std::vector<uint8_t> rgb((size_t)std::min(chunk_rows, height) * rgb_stride);
+    for (uint32_t y = 0; ok && (y < height); y += chunk_rows)
+    {
+        uint32_t rows = std::min(chunk_rows, height - y);
+        ok = (fread(rgb.data(), 1, (size_t)rows * rgb_stride, fp) == (size_t)rows * rgb_stride);
+        rgb_to_gray(rgb.data(), rgb_stride, gray_img.sub(0, y, width, rows), weights);
+    }
+
+    fclose(fp);
+    return ok;
+}
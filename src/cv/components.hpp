@@ -0,0 +1,274 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "enums.hpp"
+#include "parallel.hpp"
+#include "simd.hpp"
+#include "view.hpp"
+
+// labels are 1..N in raster order of each component's first pixel, 0 is background;
+// any non-zero pixel is foreground
+typedef struct
+{
+    uint32_t label;
+    uint64_t area;
+    uint32_t x0;    // bounding box, inclusive
+    uint32_t y0;
+    uint32_t x1;
+    uint32_t y1;
+    double cx;    // centroid
+    double cy;
+} component_t;
+
+// horizontal run of foreground pixels [x0, x1) in row y
+typedef struct
+{
+    uint32_t x0;
+    uint32_t x1;
+    uint32_t y;
+} cc_run_t;
+
+// runs of rows [y0, y1), unions done inside the strip only; parent indices are strip local
+typedef struct
+{
+    uint32_t y0;
+    uint32_t y1;
+    std::vector<cc_run_t> runs;
+    std::vector<uint32_t> row_start;    // runs of row y0 + i are [row_start[i], row_start[i + 1])
+    std::vector<uint32_t> parent;
+} cc_strip_t;
+
+// path halving, every visited node skips to its grandparent
+uint32_t cc_find(std::vector<uint32_t> &parent, uint32_t i)
+{
+    while (parent[i] != i)
+    {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+    }
+    return i;
+}
+
+// the smaller index becomes the root, so roots stay the first run in raster order
+void cc_union(std::vector<uint32_t> &parent, uint32_t a, uint32_t b)
+{
+    a = cc_find(parent, a);
+    b = cc_find(parent, b);
+    if (a < b)
+    {
+        parent[b] = a;
+    }
+    else if (b < a)
+    {
+        parent[a] = b;
+    }
+}
+
+// append the runs of one row; blocks that are all background or all foreground are skipped 16 at a time
+void cc_row_runs(const uint8_t *row, uint32_t width, uint32_t y, std::vector<cc_run_t> &runs)
+{
+    bool inside = false;
+    uint32_t start = 0;
+    uint32_t x = 0;
+    while (x < width)
+    {
+#ifdef CV_SSE2
+        if (x + 16 <= width)
+        {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row + x));
+            uint32_t background = _mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_setzero_si128()));
+            if (background == (inside ? 0x0000u : 0xFFFFu))
+            {
+                x += 16;
+                continue;
+            }
+        }
+#endif
+        bool foreground = (row[x] != 0);
+        if (foreground != inside)
+        {
+            if (inside)
+            {
+                cc_run_t run = {start, x, y};
+                runs.push_back(run);
+            }
+            start = x;
+            inside = foreground;
+        }
+        x++;
+    }
+    if (inside)
+    {
+        cc_run_t run = {start, width, y};
+        runs.push_back(run);
+    }
+}
+
+// union every pair of touching runs between two consecutive rows, both lists sorted by x;
+// with 8-connectivity runs also touch diagonally, i.e. one pixel further
+void cc_union_rows(const cc_run_t *up, uint32_t up_count, uint32_t up_base, const cc_run_t *down, uint32_t down_count,
+                   uint32_t down_base, uint32_t reach, std::vector<uint32_t> &parent)
+{
+    uint32_t i = 0;
+    uint32_t j = 0;
+    while ((i < up_count) && (j < down_count))
+    {
+        if ((up[i].x0 < down[j].x1 + reach) && (down[j].x0 < up[i].x1 + reach))
+        {
+            cc_union(parent, up_base + i, down_base + j);
+        }
+        // drop whichever run ends first, it cannot touch anything further right
+        if (up[i].x1 < down[j].x1)
+        {
+            i++;
+        }
+        else
+        {
+            j++;
+        }
+    }
+}
+
+void cc_label_strip(image_view_t img, uint32_t reach, cc_strip_t &strip)
+{
+    uint32_t width = img.width();
+    strip.row_start.push_back(0);
+    for (uint32_t y = strip.y0; y < strip.y1; y++)
+    {
+        cc_row_runs(img.row(y), width, y, strip.runs);
+        strip.row_start.push_back((uint32_t)strip.runs.size());
+    }
+
+    strip.parent.resize(strip.runs.size());
+    for (uint32_t i = 0; i < strip.parent.size(); i++)
+    {
+        strip.parent[i] = i;
+    }
+    for (uint32_t r = 1; r < strip.y1 - strip.y0; r++)
+    {
+        uint32_t up_base = strip.row_start[r - 1];
+        uint32_t down_base = strip.row_start[r];
+        cc_union_rows(strip.runs.data() + up_base, down_base - up_base, up_base, strip.runs.data() + down_base,
+                      strip.row_start[r + 1] - down_base, down_base, reach, strip.parent);
+    }
+}
+
+// two-pass labeling over runs: strips are labeled in parallel, joined along their seams,
+// then every run gets its final label. labels, when given, receives width * height entries
+std::vector<component_t> connected_components(image_view_t img, connectivity_e connectivity,
+                                              std::vector<uint32_t> *labels = NULL)
+{
+    uint32_t width = img.width();
+    uint32_t height = img.height();
+    uint32_t reach = (connectivity == eight_connected) ? 1 : 0;
+
+    std::mutex mutex;
+    std::vector<cc_strip_t> strips;
+    parallel_rows(height, [&](uint32_t y0, uint32_t y1) {
+        cc_strip_t strip;
+        strip.y0 = y0;
+        strip.y1 = y1;
+        cc_label_strip(img, reach, strip);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        strips.push_back(std::move(strip));
+    });
+    std::sort(strips.begin(), strips.end(), [](const cc_strip_t &a, const cc_strip_t &b) { return a.y0 < b.y0; });
+
+    // one forest over all runs, strip local indices shifted by the runs before them
+    std::vector<uint32_t> base(strips.size() + 1, 0);
+    for (size_t s = 0; s < strips.size(); s++)
+    {
+        base[s + 1] = base[s] + (uint32_t)strips[s].runs.size();
+    }
+    std::vector<uint32_t> parent(base.back());
+    for (size_t s = 0; s < strips.size(); s++)
+    {
+        for (size_t i = 0; i < strips[s].parent.size(); i++)
+        {
+            parent[base[s] + i] = base[s] + strips[s].parent[i];
+        }
+    }
+    for (size_t s = 1; s < strips.size(); s++)
+    {
+        const cc_strip_t &up = strips[s - 1];
+        const cc_strip_t &down = strips[s];
+        uint32_t up_rows = up.y1 - up.y0;
+        uint32_t up_first = up.row_start[up_rows - 1];
+        uint32_t up_count = up.row_start[up_rows] - up_first;
+        uint32_t down_count = down.row_start[1];
+        cc_union_rows(up.runs.data() + up_first, up_count, base[s - 1] + up_first, down.runs.data(), down_count, base[s],
+                      reach, parent);
+    }
+
+    // second pass: roots are numbered in raster order, stats accumulate per run
+    std::vector<uint32_t> run_label(parent.size());
+    std::vector<component_t> components;
+    std::vector<double> sum_x;
+    std::vector<double> sum_y;
+    for (size_t s = 0; s < strips.size(); s++)
+    {
+        const std::vector<cc_run_t> &runs = strips[s].runs;
+        for (size_t i = 0; i < runs.size(); i++)
+        {
+            uint32_t index = base[s] + (uint32_t)i;
+            uint32_t root = cc_find(parent, index);
+            uint32_t label;
+            if (root == index)
+            {
+                component_t component = {(uint32_t)components.size() + 1, 0, runs[i].x0, runs[i].y,
+                                         runs[i].x1 - 1, runs[i].y, 0, 0};
+                components.push_back(component);
+                sum_x.push_back(0);
+                sum_y.push_back(0);
+                label = component.label;
+            }
+            else
+            {
+                label = run_label[root];
+            }
+            run_label[index] = label;
+
+            const cc_run_t &run = runs[i];
+            component_t &component = components[label - 1];
+            uint64_t length = run.x1 - run.x0;
+            component.area += length;
+            component.x0 = std::min(component.x0, run.x0);
+            component.x1 = std::max(component.x1, run.x1 - 1);
+            component.y1 = run.y;
+            sum_x[label - 1] += (double)length * (run.x0 + run.x1 - 1) / 2;
+            sum_y[label - 1] += (double)length * run.y;
+        }
+    }
+    for (size_t c = 0; c < components.size(); c++)
+    {
+        components[c].cx = sum_x[c] / components[c].area;
+        components[c].cy = sum_y[c] / components[c].area;
+    }
+
+    if (labels != NULL)
+    {
+        // strips own disjoint rows, so they are written in parallel again
+        labels->assign((size_t)width * height, 0);
+        parallel_rows(
+            (uint32_t)strips.size(),
+            [&](uint32_t s0, uint32_t s1) {
+                for (uint32_t s = s0; s < s1; s++)
+                {
+                    const std::vector<cc_run_t> &runs = strips[s].runs;
+                    for (size_t i = 0; i < runs.size(); i++)
+                    {
+                        uint32_t *row = labels->data() + (size_t)runs[i].y * width;
+                        std::fill(row + runs[i].x0, row + runs[i].x1, run_label[base[s] + i]);
+                    }
+                }
+            },
+            1);
+    }
+    return components;
+}
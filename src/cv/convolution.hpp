@@ -1,83 +1,39 @@
 #pragma once
 
+#include <vector>
+
+#include "border.hpp"
+#include "dispatch.hpp"
 #include "enums.hpp"
 #include "pgm.hpp"
+#include "view.hpp"
 
-void convolve(pgm_t &src_img, pgm_t &dst_img, const int8_t *kernel, uint8_t k_size,
+void convolve(image_view_t src_img, image_view_t dst_img, const int8_t *kernel, uint8_t k_size,
               const int16_t div_factor, edge_e edge)
 {
     int width = src_img.width();
     int height = src_img.height();
-    uint8_t *src_ptr = src_img.ptr();
-    uint8_t *dst_ptr = dst_img.ptr();
+    int k_half_size = (k_size - 1) / 2;
 
-    uint8_t k_half_size = (k_size - 1) / 2;
+    // every source row padded once with the edge mode, rows above / below the image map
+    // through border_index and land on the all-zero row for zero padding
+    int padded_width = width + 2 * k_half_size;
+    std::vector<uint8_t> padded((size_t)padded_width * (height + 1), 0);
+    for (int y = 0; y < height; y++)
+    {
+        pad_line(src_img.row(y), width, &padded[(size_t)y * padded_width], k_half_size, k_half_size, edge);
+    }
+    const uint8_t *zero_row = &padded[(size_t)height * padded_width];
 
-    for (uint32_t y = 0; y < height; y++)
+    const simd_kernels_t &kernels = simd_kernels();
+    std::vector<const uint8_t *> rows(k_size);
+    for (int y = 0; y < height; y++)
     {
-        for (uint32_t x = 0; x < width; x++)
+        for (int k_y = 0; k_y < k_size; k_y++)
         {
-            int16_t sum = 0;
-            for (int k_y = -k_half_size; k_y <= k_half_size; k_y++)
-            {
-                for (int k_x = -k_half_size; k_x <= k_half_size; k_x++)
-                {
-                    int pos_y = y + k_y;
-                    int pos_x = x + k_x;
-                    if ((pos_x >= 0) && (pos_x < width) && (pos_y >= 0) && (pos_y < height))
-                    {
-                        sum += src_ptr[pos_y * width + pos_x] *
-                               kernel[(k_y + k_half_size) * k_size + (k_x + k_half_size)];
-                    }
-                    else if (edge == clamp)
-                    {
-                        if (pos_x < 0)
-                        {
-                            pos_x = 0;
-                        }
-                        else if (pos_x >= width)
-                        {
-                            pos_x = width - 1;
-                        }
-
-                        if (pos_y < 0)
-                        {
-                            pos_y = 0;
-                        }
-                        else if (pos_y >= height)
-                        {
-                            pos_y = height - 1;
-                        }
-
-                        sum += src_ptr[pos_y * width + pos_x] *
-                               kernel[(k_y + k_half_size) * k_size + (k_x + k_half_size)];
-                    }
-                    else if (edge == mirror)
-                    {
-                        if (pos_x < 0)
-                        {
-                            pos_x = -(pos_x);
-                        }
-                        else if (pos_x >= width)
-                        {
-                            pos_x = width - (pos_x - width) - 1;
-                        }
-
-                        if (pos_y < 0)
-                        {
-                            pos_y = -(pos_y);
-                        }
-                        else if (pos_y >= height)
-                        {
-                            pos_y = height - (pos_y - height) - 1;
-                        }
-
-                        sum += src_ptr[pos_y * width + pos_x] *
-                               kernel[(k_y + k_half_size) * k_size + (k_x + k_half_size)];
-                    }
-                }
-            }
-            dst_ptr[y * width + x] = (uint8_t)(abs(sum / div_factor));
+            int pos_y = border_index(y + k_y - k_half_size, height, edge);
+            rows[k_y] = (pos_y < 0) ? zero_row : &padded[(size_t)pos_y * padded_width];
         }
+        kernels.convolve_row(rows.data(), kernel, k_size, div_factor, dst_img.row(y), width);
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "cpu.hpp"
+#include "simd_kernels.hpp"
+
+const simd_kernels_t *simd_kernels_for(simd_level_e level)
+{
+    switch (level)
+    {
+    case simd_avx512:
+        return &simd_kernels_avx512;
+    case simd_avx2:
+        return &simd_kernels_avx2;
+    case simd_sse42:
+        return &simd_kernels_sse42;
+    default:
+        return &simd_kernels_scalar;
+    }
+}
+
+// table for the level picked by simd_level(), bound once on first use
+const simd_kernels_t &simd_kernels()
+{
+    static const simd_kernels_t &kernels = *simd_kernels_for(simd_level());
+    return kernels;
+}
@@ -1,10 +1,16 @@
 #pragma once
 
 #include <cmath>
+#include <cstring>
+#include <mutex>
 
 #include "convolution.hpp"
+#include "dispatch.hpp"
 #include "enums.hpp"
+#include "parallel.hpp"
 #include "pgm.hpp"
+#include "stats.hpp"
+#include "view.hpp"
 
 static const int8_t prewitt_x_kernel[9] = {-1, 0, 1, -1, 0, 1, -1, 0, 1};
 static const int8_t prewitt_y_kernel[9] = {-1, -1, -1, 0, 0, 0, 1, 1, 1};
@@ -14,33 +20,71 @@ static const int8_t sobel_x_kernel[9] = {-1, 0, 1, -2, 0, 2, -1, 0, 1};
 static const int8_t sobel_y_kernel[9] = {-1, -2, -1, 0, 0, 0, 1, 2, 1};
 static const int16_t sobel_div_factor = 4;
 
-void edgeX(pgm_t &src_img, pgm_t &dst_img, edge_e edge)
+// what edgeX() / edgeY() apply, also folded into cache keys
+static const int8_t *const edge_x_kernel = sobel_x_kernel;
+static const int8_t *const edge_y_kernel = sobel_y_kernel;
+static const int16_t edge_div_factor = sobel_div_factor;
+
+void edgeX(image_view_t src_img, image_view_t dst_img, edge_e edge)
 {
-    convolve(src_img, dst_img, sobel_x_kernel, 3, sobel_div_factor, edge);
+    convolve(src_img, dst_img, edge_x_kernel, 3, edge_div_factor, edge);
 }
 
-void edgeY(pgm_t &src_img, pgm_t &dst_img, edge_e edge)
+void edgeY(image_view_t src_img, image_view_t dst_img, edge_e edge)
 {
-    convolve(src_img, dst_img, sobel_y_kernel, 3, sobel_div_factor, edge);
+    convolve(src_img, dst_img, edge_y_kernel, 3, edge_div_factor, edge);
 }
 
-void edgeRms(pgm_t &edgeX_img, pgm_t &edgeY_img, pgm_t &dst_img, uint8_t threshold)
+void edgeRms(image_view_t edgeX_img, image_view_t edgeY_img, image_view_t dst_img, uint8_t threshold)
 {
     int width = dst_img.width();
     int height = dst_img.height();
-    uint8_t *edgeX_ptr = edgeX_img.ptr();
-    uint8_t *edgeY_ptr = edgeY_img.ptr();
-    uint8_t *dst_ptr = dst_img.ptr();
-
+    const simd_kernels_t &kernels = simd_kernels();
     for (uint32_t y = 0; y < height; y++)
     {
-        for (uint32_t x = 0; x < width; x++)
+        kernels.edge_rms_row(edgeX_img.row(y), edgeY_img.row(y), dst_img.row(y), width, threshold);
+    }
+}
+
+// edgeRms() with the threshold picked from the magnitude histogram; each row is histogrammed
+// right after it is written, while still in cache, so only the final cut touches dst again.
+// returns the threshold used
+uint8_t edgeRmsAuto(image_view_t edgeX_img, image_view_t edgeY_img, image_view_t dst_img, threshold_e method)
+{
+    int width = dst_img.width();
+    int height = dst_img.height();
+    const simd_kernels_t &kernels = simd_kernels();
+
+    image_stats_t stats;
+    memset(stats.hist, 0, sizeof(stats.hist));
+    std::mutex mutex;
+    parallel_rows(height, [&](uint32_t y0, uint32_t y1) {
+        uint32_t hist[256] = {0};
+        for (uint32_t y = y0; y < y1; y++)
         {
-            uint8_t x_val = edgeX_ptr[y * width + x];
-            uint8_t y_val = edgeY_ptr[y * width + x];
+            kernels.edge_rms_row(edgeX_img.row(y), edgeY_img.row(y), dst_img.row(y), width, 0);
+            kernels.freq_row(dst_img.row(y), width, hist);
+        }
 
-            uint8_t rms = sqrt((x_val * x_val + y_val * y_val) / 2);
-            dst_ptr[y * width + x] = (rms > threshold) ? ((uint8_t)rms) : (0);
+        std::lock_guard<std::mutex> lock(mutex);
+        for (uint32_t v = 0; v < 256; v++)
+        {
+            stats.hist[v] += hist[v];
         }
+    });
+    stats_from_hist(stats);
+
+    uint8_t threshold = auto_threshold(stats, method);
+    uint8_t lut[256];
+    for (uint32_t v = 0; v < 256; v++)
+    {
+        lut[v] = (v > threshold) ? v : 0;
     }
+    parallel_rows(height, [&](uint32_t y0, uint32_t y1) {
+        for (uint32_t y = y0; y < y1; y++)
+        {
+            kernels.lut_row(dst_img.row(y), dst_img.row(y), width, lut);
+        }
+    });
+    return threshold;
 }
\ No newline at end of file
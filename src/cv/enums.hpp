@@ -11,4 +11,22 @@ enum resize_e
 {
     nearest_neighbor = 0,
     bilinear = 1
+};
+
+enum threshold_e
+{
+    otsu = 0,
+    triangle = 1
+};
+
+enum connectivity_e
+{
+    four_connected = 4,
+    eight_connected = 8
+};
+
+enum gray_weights_e
+{
+    bt601 = 0,
+    bt709 = 1
 };
\ No newline at end of file
@@ -1,27 +1,28 @@
 #pragma once
 
+#include "dispatch.hpp"
 #include "pgm.hpp"
+#include "view.hpp"
 
-static uint32_t s_freq[255];
-static uint32_t s_cum_freq[255];
-static double s_cum_prob[255];
+static uint32_t s_freq[256];
+static uint32_t s_cum_freq[256];
+static double s_cum_prob[256];
 static uint32_t s_num_samples;
 
-void calc_freq(pgm_t &img)
+void calc_freq(image_view_t img)
 {
     s_num_samples = img.width() * img.height();
-    uint8_t *img_ptr = img.ptr();
-    for (uint32_t i = 0; i < s_num_samples; i++)
+    const simd_kernels_t &kernels = simd_kernels();
+    for (uint32_t y = 0; y < img.height(); y++)
     {
-        uint8_t val = *(img_ptr + i);
-        s_freq[val]++;
+        kernels.freq_row(img.row(y), img.width(), s_freq);
     }
 }
 
 void calc_cum_freq()
 {
     uint32_t cum_sum = 0;
-    for (uint32_t i = 0; i < 255; i++)
+    for (uint32_t i = 0; i < 256; i++)
     {
         cum_sum += s_freq[i];
         s_cum_freq[i] = cum_sum;
@@ -29,18 +30,23 @@ void calc_cum_freq()
     }
 }
 
-void apply_hist_eq(pgm_t &img)
+void apply_hist_eq(image_view_t img)
 {
-    uint8_t *img_ptr = img.ptr();
-    for (uint32_t i = 0; i < s_num_samples; i++)
+    // the mapping only depends on the pixel value, so it becomes a 256 entry table
+    uint8_t lut[256];
+    for (uint32_t val = 0; val < 256; val++)
     {
-        uint8_t val = *(img_ptr + i);
-        uint8_t eq_val = val * s_cum_prob[val];
-        *(img_ptr + i) = eq_val;
+        lut[val] = val * s_cum_prob[val];
+    }
+
+    const simd_kernels_t &kernels = simd_kernels();
+    for (uint32_t y = 0; y < img.height(); y++)
+    {
+        kernels.lut_row(img.row(y), img.row(y), img.width(), lut);
     }
 }
 
-void histogram(pgm_t &img)
+void histogram(image_view_t img)
 {
     memset(s_freq, 0, sizeof(s_freq));
     memset(s_cum_freq, 0, sizeof(s_cum_freq));
@@ -0,0 +1,200 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+// LZ4 block format: [token][literal length ext][literals][offset lo/hi][match length ext]
+// token = (literal length << 4) | (match length - 4), with 15 meaning "continued in ext bytes"
+
+#define LZ_MIN_MATCH  4
+#define LZ_HASH_BITS  12
+#define LZ_LAST_LITS  5
+#define LZ_MFLIMIT    12
+#define LZ_MAX_OFFSET 65535
+
+static uint32_t lz_read32(const uint8_t *ptr)
+{
+    uint32_t val;
+    memcpy(&val, ptr, sizeof(val));
+    return val;
+}
+
+static uint32_t lz_hash(uint32_t val) { return (val * 2654435761U) >> (32 - LZ_HASH_BITS); }
+
+static uint8_t *lz_write_length(uint8_t *dst, uint32_t len)
+{
+    while (len >= 255)
+    {
+        *dst++ = 255;
+        len -= 255;
+    }
+    *dst++ = (uint8_t)len;
+    return dst;
+}
+
+// returns compressed size, or 0 if the output would not fit in dst_capacity
+uint32_t lz_compress(const uint8_t *src, uint32_t src_size, uint8_t *dst, uint32_t dst_capacity)
+{
+    uint32_t table[1 << LZ_HASH_BITS];
+    memset(table, 0xFF, sizeof(table));
+
+    const uint8_t *dst_end = dst + dst_capacity;
+    uint8_t *out = dst;
+    uint32_t anchor = 0;
+    uint32_t pos = 0;
+
+    if (src_size > LZ_MFLIMIT)
+    {
+        uint32_t match_limit = src_size - LZ_MFLIMIT;
+        while (pos < match_limit)
+        {
+            uint32_t seq = lz_read32(src + pos);
+            uint32_t h = lz_hash(seq);
+            uint32_t ref = table[h];
+            table[h] = pos;
+
+            if ((ref == 0xFFFFFFFFU) || (pos - ref > LZ_MAX_OFFSET) || (lz_read32(src + ref) != seq))
+            {
+                pos++;
+                continue;
+            }
+
+            // extend match, keeping the last literals out of it
+            uint32_t match_len = LZ_MIN_MATCH;
+            uint32_t max_len = src_size - LZ_LAST_LITS - pos;
+            while ((match_len < max_len) && (src[ref + match_len] == src[pos + match_len]))
+            {
+                match_len++;
+            }
+
+            uint32_t lit_len = pos - anchor;
+            if (out + 1 + lit_len / 255 + 1 + lit_len + 2 + match_len / 255 + 1 > dst_end)
+            {
+                return 0;
+            }
+
+            uint8_t *token = out++;
+            *token = (uint8_t)(((lit_len >= 15) ? 15 : lit_len) << 4);
+            if (lit_len >= 15)
+            {
+                out = lz_write_length(out, lit_len - 15);
+            }
+            memcpy(out, src + anchor, lit_len);
+            out += lit_len;
+
+            uint32_t offset = pos - ref;
+            *out++ = (uint8_t)(offset & 0xFF);
+            *out++ = (uint8_t)(offset >> 8);
+
+            uint32_t ext_len = match_len - LZ_MIN_MATCH;
+            *token |= (uint8_t)((ext_len >= 15) ? 15 : ext_len);
+            if (ext_len >= 15)
+            {
+                out = lz_write_length(out, ext_len - 15);
+            }
+
+            pos += match_len;
+            anchor = pos;
+        }
+    }
+
+    // trailing literals
+    uint32_t lit_len = src_size - anchor;
+    if (out + 1 + lit_len / 255 + 1 + lit_len > dst_end)
+    {
+        return 0;
+    }
+    uint8_t *token = out++;
+    *token = (uint8_t)(((lit_len >= 15) ? 15 : lit_len) << 4);
+    if (lit_len >= 15)
+    {
+        out = lz_write_length(out, lit_len - 15);
+    }
+    memcpy(out, src + anchor, lit_len);
+    out += lit_len;
+
+    return (uint32_t)(out - dst);
+}
+
+// returns decompressed size, or 0 on malformed input
+uint32_t lz_decompress(const uint8_t *src, uint32_t src_size, uint8_t *dst, uint32_t dst_capacity)
+{
+    const uint8_t *in = src;
+    const uint8_t *in_end = src + src_size;
+    uint8_t *out = dst;
+    uint8_t *out_end = dst + dst_capacity;
+
+    while (in < in_end)
+    {
+        uint8_t token = *in++;
+
+        uint32_t lit_len = token >> 4;
+        if (lit_len == 15)
+        {
+            uint8_t ext;
+            do
+            {
+                if (in >= in_end)
+                {
+                    return 0;
+                }
+                ext = *in++;
+                lit_len += ext;
+            } while (ext == 255);
+        }
+        if ((in + lit_len > in_end) || (out + lit_len > out_end))
+        {
+            return 0;
+        }
+        memcpy(out, in, lit_len);
+        in += lit_len;
+        out += lit_len;
+
+        // last sequence has literals only
+        if (in == in_end)
+        {
+            break;
+        }
+
+        if (in + 2 > in_end)
+        {
+            return 0;
+        }
+        uint32_t offset = in[0] | (in[1] << 8);
+        in += 2;
+        if ((offset == 0) || (offset > (uint32_t)(out - dst)))
+        {
+            return 0;
+        }
+
+        uint32_t match_len = token & 0x0F;
+        if (match_len == 15)
+        {
+            uint8_t ext;
+            do
+            {
+                if (in >= in_end)
+                {
+                    return 0;
+                }
+                ext = *in++;
+                match_len += ext;
+            } while (ext == 255);
+        }
+        match_len += LZ_MIN_MATCH;
+        if (out + match_len > out_end)
+        {
+            return 0;
+        }
+
+        // byte copy handles overlapping matches (offset < match_len)
+        const uint8_t *ref = out - offset;
+        for (uint32_t i = 0; i < match_len; i++)
+        {
+            out[i] = ref[i];
+        }
+        out += match_len;
+    }
+
+    return (uint32_t)(out - dst);
+}
@@ -0,0 +1,327 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "border.hpp"
+#include "enums.hpp"
+#include "parallel.hpp"
+#include "simd.hpp"
+#include "view.hpp"
+
+// 3x3 and 5x5 use sorting networks evaluated on 16 pixels at once,
+// larger windows use the Perreault-Hebert constant time histogram median
+#define MEDIAN_MAX_RADIUS 127
+
+template <typename T>
+void median_sort2(T &a, T &b)
+{
+    T lo = min_op::apply(a, b);
+    b = max_op::apply(a, b);
+    a = lo;
+}
+
+// Paeth's 19 exchange median of 9, result in p[4]
+template <typename T>
+T median9(T *p)
+{
+    median_sort2(p[1], p[2]);
+    median_sort2(p[4], p[5]);
+    median_sort2(p[7], p[8]);
+    median_sort2(p[0], p[1]);
+    median_sort2(p[3], p[4]);
+    median_sort2(p[6], p[7]);
+    median_sort2(p[1], p[2]);
+    median_sort2(p[4], p[5]);
+    median_sort2(p[7], p[8]);
+    median_sort2(p[0], p[3]);
+    median_sort2(p[5], p[8]);
+    median_sort2(p[4], p[7]);
+    median_sort2(p[3], p[6]);
+    median_sort2(p[1], p[4]);
+    median_sort2(p[2], p[5]);
+    median_sort2(p[4], p[7]);
+    median_sort2(p[4], p[2]);
+    median_sort2(p[6], p[4]);
+    median_sort2(p[4], p[2]);
+    return p[4];
+}
+
+// Batcher odd-even merge sort over 32 lanes: 25 samples plus 3 zeros and 4 maxes
+// leave the median of the samples at index 15
+typedef struct
+{
+    uint8_t a;
+    uint8_t b;
+} median_pair_t;
+
+std::vector<median_pair_t> build_median25_network()
+{
+    std::vector<median_pair_t> network;
+    const uint32_t n = 32;
+    for (uint32_t p = 1; p < n; p <<= 1)
+    {
+        for (uint32_t k = p; k >= 1; k >>= 1)
+        {
+            for (uint32_t j = k % p; j + k < n; j += 2 * k)
+            {
+                for (uint32_t i = 0; (i < k) && (i + j + k < n); i++)
+                {
+                    if ((i + j) / (2 * p) == (i + j + k) / (2 * p))
+                    {
+                        median_pair_t pair = {(uint8_t)(i + j), (uint8_t)(i + j + k)};
+                        network.push_back(pair);
+                    }
+                }
+            }
+        }
+    }
+    return network;
+}
+
+const std::vector<median_pair_t> &median25_network()
+{
+    static const std::vector<median_pair_t> network = build_median25_network();
+    return network;
+}
+
+template <typename T>
+T median25(T *p, const std::vector<median_pair_t> &network)
+{
+    for (size_t i = 0; i < network.size(); i++)
+    {
+        median_sort2(p[network[i].a], p[network[i].b]);
+    }
+    return p[15];
+}
+
+// rows [y0, y1) of a window median using a sorting network, padded is offset by radius
+void median_network_band(const uint8_t *padded, uint32_t p_stride, image_view_t dst_img, uint32_t radius,
+                         uint32_t y0, uint32_t y1)
+{
+    const std::vector<median_pair_t> &network = median25_network();
+    uint32_t width = dst_img.width();
+    uint32_t k_size = 2 * radius + 1;
+
+    for (uint32_t y = y0; y < y1; y++)
+    {
+        uint8_t *dst_ptr = dst_img.row(y);
+        const uint8_t *src_ptr = padded + (size_t)y * p_stride;
+        uint32_t x = 0;
+
+#ifdef CV_SSE2
+        __m128i v[32];
+        for (; x + 16 <= width; x += 16)
+        {
+            uint32_t n = 0;
+            for (uint32_t k_y = 0; k_y < k_size; k_y++)
+            {
+                for (uint32_t k_x = 0; k_x < k_size; k_x++)
+                {
+                    v[n++] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src_ptr + k_y * p_stride + x + k_x));
+                }
+            }
+
+            __m128i result;
+            if (radius == 1)
+            {
+                result = median9(v);
+            }
+            else
+            {
+                for (; n < 28; n++)
+                {
+                    v[n] = _mm_setzero_si128();
+                }
+                for (; n < 32; n++)
+                {
+                    v[n] = _mm_set1_epi8((char)0xFF);
+                }
+                result = median25(v, network);
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst_ptr + x), result);
+        }
+#endif
+
+        uint8_t s[32];
+        for (; x < width; x++)
+        {
+            uint32_t n = 0;
+            for (uint32_t k_y = 0; k_y < k_size; k_y++)
+            {
+                for (uint32_t k_x = 0; k_x < k_size; k_x++)
+                {
+                    s[n++] = src_ptr[k_y * p_stride + x + k_x];
+                }
+            }
+
+            if (radius == 1)
+            {
+                dst_ptr[x] = median9(s);
+            }
+            else
+            {
+                memset(s + 25, 0, 3);
+                memset(s + 28, 0xFF, 4);
+                dst_ptr[x] = median25(s, network);
+            }
+        }
+    }
+}
+
+void median_hist_add(uint16_t *dst, const uint16_t *src, uint32_t n)
+{
+    uint32_t i = 0;
+#ifdef CV_SSE2
+    for (; i + 8 <= n; i += 8)
+    {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(dst + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_add_epi16(a, b));
+    }
+#endif
+    for (; i < n; i++)
+    {
+        dst[i] += src[i];
+    }
+}
+
+void median_hist_sub(uint16_t *dst, const uint16_t *src, uint32_t n)
+{
+    uint32_t i = 0;
+#ifdef CV_SSE2
+    for (; i + 8 <= n; i += 8)
+    {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(dst + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_sub_epi16(a, b));
+    }
+#endif
+    for (; i < n; i++)
+    {
+        dst[i] -= src[i];
+    }
+}
+
+// Perreault-Hebert: one histogram per padded column slides down one row at a time,
+// the kernel histogram slides right by adding one column histogram and removing another.
+// Histograms are two level (16 coarse + 256 fine bins) so the median search is 32 steps.
+void median_histogram_band(const uint8_t *padded, uint32_t p_stride, image_view_t dst_img, uint32_t radius,
+                           uint32_t y0, uint32_t y1)
+{
+    uint32_t width = dst_img.width();
+    uint32_t p_width = width + 2 * radius;
+    uint32_t k_size = 2 * radius + 1;
+    uint32_t rank = (k_size * k_size) / 2;
+
+    std::vector<uint16_t> col_fine((size_t)p_width * 256, 0);
+    std::vector<uint16_t> col_coarse((size_t)p_width * 16, 0);
+    uint16_t fine[256];
+    uint16_t coarse[16];
+
+    // columns start covering padded rows [y0, y0 + 2r]
+    for (uint32_t p = y0; p < y0 + k_size; p++)
+    {
+        const uint8_t *row = padded + (size_t)p * p_stride;
+        for (uint32_t c = 0; c < p_width; c++)
+        {
+            col_fine[c * 256 + row[c]]++;
+            col_coarse[c * 16 + (row[c] >> 4)]++;
+        }
+    }
+
+    for (uint32_t y = y0; y < y1; y++)
+    {
+        if (y > y0)
+        {
+            const uint8_t *out_row = padded + (size_t)(y - 1) * p_stride;
+            const uint8_t *in_row = padded + (size_t)(y + 2 * radius) * p_stride;
+            for (uint32_t c = 0; c < p_width; c++)
+            {
+                col_fine[c * 256 + out_row[c]]--;
+                col_coarse[c * 16 + (out_row[c] >> 4)]--;
+                col_fine[c * 256 + in_row[c]]++;
+                col_coarse[c * 16 + (in_row[c] >> 4)]++;
+            }
+        }
+
+        memset(fine, 0, sizeof(fine));
+        memset(coarse, 0, sizeof(coarse));
+        for (uint32_t c = 0; c < 2 * radius; c++)
+        {
+            median_hist_add(fine, &col_fine[c * 256], 256);
+            median_hist_add(coarse, &col_coarse[c * 16], 16);
+        }
+
+        uint8_t *dst_ptr = dst_img.row(y);
+        for (uint32_t x = 0; x < width; x++)
+        {
+            median_hist_add(fine, &col_fine[(x + 2 * radius) * 256], 256);
+            median_hist_add(coarse, &col_coarse[(x + 2 * radius) * 16], 16);
+
+            uint32_t count = 0;
+            uint32_t bin = 0;
+            while (count + coarse[bin] <= rank)
+            {
+                count += coarse[bin++];
+            }
+            bin *= 16;
+            while (count + fine[bin] <= rank)
+            {
+                count += fine[bin++];
+            }
+            dst_ptr[x] = (uint8_t)bin;
+
+            median_hist_sub(fine, &col_fine[x * 256], 256);
+            median_hist_sub(coarse, &col_coarse[x * 16], 16);
+        }
+    }
+}
+
+void median(image_view_t src_img, image_view_t dst_img, uint8_t k_size, edge_e edge)
+{
+    assert((src_img.width() == dst_img.width()) && (src_img.height() == dst_img.height()));
+    assert((k_size % 2 == 1) && (k_size / 2 <= MEDIAN_MAX_RADIUS));
+
+    int width = src_img.width();
+    int height = src_img.height();
+    uint32_t radius = k_size / 2;
+    uint32_t p_stride = width + 2 * radius;
+
+    // pad once so the inner loops never see a border
+    std::vector<uint8_t> padded((size_t)p_stride * (height + 2 * radius));
+    for (int p = 0; p < height + 2 * (int)radius; p++)
+    {
+        uint8_t *dst_ptr = &padded[(size_t)p * p_stride];
+        int pos = border_index(p - (int)radius, height, edge);
+        if (pos < 0)
+        {
+            memset(dst_ptr, 0, p_stride);
+        }
+        else
+        {
+            pad_line(src_img.row(pos), width, dst_ptr, radius, radius, edge);
+        }
+    }
+
+    const uint8_t *padded_ptr = padded.data();
+    parallel_rows(height, [&](uint32_t y0, uint32_t y1) {
+        if (radius == 0)
+        {
+            for (uint32_t y = y0; y < y1; y++)
+            {
+                memcpy(dst_img.row(y), src_img.row(y), width);
+            }
+        }
+        else if (radius <= 2)
+        {
+            median_network_band(padded_ptr, p_stride, dst_img, radius, y0, y1);
+        }
+        else
+        {
+            median_histogram_band(padded_ptr, p_stride, dst_img, radius, y0, y1);
+        }
+    });
+}
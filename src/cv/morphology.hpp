@@ -0,0 +1,212 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "border.hpp"
+#include "enums.hpp"
+#include "simd.hpp"
+#include "view.hpp"
+
+// van Herk / Gil-Werman: per block of k samples keep a forward prefix g and a backward suffix h,
+// then any window [i, i + k) is op(h[i], g[i + k - 1]), i.e. 3 comparisons per sample for any k
+#define MORPH_DIRECT_MAX_K 3
+
+template <typename op_t>
+void morph_line(const uint8_t *src, uint8_t *dst, uint8_t *g, uint8_t *h, uint32_t n, uint32_t k)
+{
+    // src holds n + k - 1 padded samples, dst receives n
+    uint32_t padded = n + k - 1;
+
+    if (k <= MORPH_DIRECT_MAX_K)
+    {
+        row_apply<op_t>(src, src + (k > 1 ? 1 : 0), dst, n);
+        for (uint32_t i = 2; i < k; i++)
+        {
+            row_apply<op_t>(dst, src + i, dst, n);
+        }
+        return;
+    }
+
+    for (uint32_t start = 0; start < padded; start += k)
+    {
+        uint32_t end = (start + k < padded) ? (start + k) : padded;
+        g[start] = src[start];
+        for (uint32_t i = start + 1; i < end; i++)
+        {
+            g[i] = op_t::apply(g[i - 1], src[i]);
+        }
+        h[end - 1] = src[end - 1];
+        for (uint32_t i = end - 1; i > start; i--)
+        {
+            h[i - 1] = op_t::apply(h[i], src[i - 1]);
+        }
+    }
+    for (uint32_t i = 0; i < n; i++)
+    {
+        dst[i] = op_t::apply(h[i], g[i + k - 1]);
+    }
+}
+
+template <typename op_t>
+void morph_rows(image_view_t src_img, image_view_t dst_img, uint32_t k, edge_e edge)
+{
+    uint32_t width = src_img.width();
+    uint32_t height = src_img.height();
+    uint32_t pad_left = (k - 1) / 2;
+    uint32_t pad_right = k - 1 - pad_left;
+
+    std::vector<uint8_t> line(width + k - 1);
+    std::vector<uint8_t> g(width + k - 1);
+    std::vector<uint8_t> h(width + k - 1);
+
+    for (uint32_t y = 0; y < height; y++)
+    {
+        pad_line(src_img.row(y), width, line.data(), pad_left, pad_right, edge);
+        morph_line<op_t>(line.data(), dst_img.row(y), g.data(), h.data(), width, k);
+    }
+}
+
+// vertical pass works on whole rows at a time so every step is a vectorized row_apply
+template <typename op_t>
+void morph_cols(image_view_t src_img, image_view_t dst_img, uint32_t k, edge_e edge)
+{
+    uint32_t width = src_img.width();
+    int height = src_img.height();
+    int pad_top = (k - 1) / 2;
+    int padded = height + k - 1;
+
+    // padded row pointers, zero padding points at a blank row
+    std::vector<uint8_t> zero_row(width, 0);
+    std::vector<const uint8_t *> rows(padded);
+    for (int i = 0; i < padded; i++)
+    {
+        int pos = border_index(i - pad_top, height, edge);
+        rows[i] = (pos < 0) ? zero_row.data() : src_img.row(pos);
+    }
+
+    if (k <= MORPH_DIRECT_MAX_K)
+    {
+        for (int y = 0; y < height; y++)
+        {
+            row_apply<op_t>(rows[y], rows[y + (k > 1 ? 1 : 0)], dst_img.row(y), width);
+            for (uint32_t i = 2; i < k; i++)
+            {
+                row_apply<op_t>(dst_img.row(y), rows[y + i], dst_img.row(y), width);
+            }
+        }
+        return;
+    }
+
+    // g/h are kept per block only, one block of k rows at a time
+    std::vector<uint8_t> g((size_t)2 * k * width);
+    std::vector<uint8_t> h((size_t)k * width);
+    for (int start = 0; start < height; start += k)
+    {
+        // suffix h over rows [start, start + k) and prefix g over [start + k, start + 2k)
+        int block_end = (start + (int)k < padded) ? (start + (int)k) : padded;
+        int n_h = block_end - start;
+        memcpy(&h[(size_t)(n_h - 1) * width], rows[block_end - 1], width);
+        for (int i = n_h - 1; i > 0; i--)
+        {
+            row_apply<op_t>(&h[(size_t)i * width], rows[start + i - 1], &h[(size_t)(i - 1) * width], width);
+        }
+
+        int g_end = (block_end + (int)k < padded) ? (block_end + (int)k) : padded;
+        int n_g = g_end - block_end;
+        if (n_g > 0)
+        {
+            memcpy(&g[0], rows[block_end], width);
+            for (int i = 1; i < n_g; i++)
+            {
+                row_apply<op_t>(&g[(size_t)(i - 1) * width], rows[block_end + i], &g[(size_t)i * width], width);
+            }
+        }
+
+        for (int y = start; (y < start + (int)k) && (y < height); y++)
+        {
+            // window [y, y + k) = suffix of this block from y, prefix of the next block up to y + k - 1
+            int i = y - start;
+            if (i == 0)
+            {
+                memcpy(dst_img.row(y), &h[0], width);
+            }
+            else
+            {
+                row_apply<op_t>(&h[(size_t)i * width], &g[(size_t)(i - 1) * width], dst_img.row(y), width);
+            }
+        }
+    }
+}
+
+template <typename op_t>
+void morph(image_view_t src_img, image_view_t dst_img, uint32_t k_width, uint32_t k_height, edge_e edge)
+{
+    assert((src_img.width() == dst_img.width()) && (src_img.height() == dst_img.height()));
+    assert((k_width > 0) && (k_height > 0));
+
+    std::vector<uint8_t> tmp((size_t)src_img.width() * src_img.height());
+    image_view_t tmp_img(tmp.data(), src_img.width(), src_img.height(), src_img.width());
+
+    morph_rows<op_t>(src_img, tmp_img, k_width, edge);
+    morph_cols<op_t>(tmp_img, dst_img, k_height, edge);
+}
+
+void erode(image_view_t src_img, image_view_t dst_img, uint32_t k_width, uint32_t k_height, edge_e edge)
+{
+    morph<min_op>(src_img, dst_img, k_width, k_height, edge);
+}
+
+void dilate(image_view_t src_img, image_view_t dst_img, uint32_t k_width, uint32_t k_height, edge_e edge)
+{
+    morph<max_op>(src_img, dst_img, k_width, k_height, edge);
+}
+
+void opening(image_view_t src_img, image_view_t dst_img, uint32_t k_width, uint32_t k_height, edge_e edge)
+{
+    std::vector<uint8_t> tmp((size_t)src_img.width() * src_img.height());
+    image_view_t tmp_img(tmp.data(), src_img.width(), src_img.height(), src_img.width());
+
+    erode(src_img, tmp_img, k_width, k_height, edge);
+    dilate(tmp_img, dst_img, k_width, k_height, edge);
+}
+
+void closing(image_view_t src_img, image_view_t dst_img, uint32_t k_width, uint32_t k_height, edge_e edge)
+{
+    std::vector<uint8_t> tmp((size_t)src_img.width() * src_img.height());
+    image_view_t tmp_img(tmp.data(), src_img.width(), src_img.height(), src_img.width());
+
+    dilate(src_img, tmp_img, k_width, k_height, edge);
+    erode(tmp_img, dst_img, k_width, k_height, edge);
+}
+
+// dilate - erode
+void morph_gradient(image_view_t src_img, image_view_t dst_img, uint32_t k_width, uint32_t k_height, edge_e edge)
+{
+    std::vector<uint8_t> tmp((size_t)src_img.width() * src_img.height());
+    image_view_t tmp_img(tmp.data(), src_img.width(), src_img.height(), src_img.width());
+
+    erode(src_img, tmp_img, k_width, k_height, edge);
+    dilate(src_img, dst_img, k_width, k_height, edge);
+
+    for (uint32_t y = 0; y < dst_img.height(); y++)
+    {
+        uint8_t *dst_ptr = dst_img.row(y);
+        uint8_t *tmp_ptr = tmp_img.row(y);
+        uint32_t x = 0;
+#ifdef CV_SSE2
+        for (; x + 16 <= dst_img.width(); x += 16)
+        {
+            __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i *>(dst_ptr + x));
+            __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i *>(tmp_ptr + x));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst_ptr + x), _mm_subs_epu8(hi, lo));
+        }
+#endif
+        for (; x < dst_img.width(); x++)
+        {
+            dst_ptr[x] = dst_ptr[x] - tmp_ptr[x];
+        }
+    }
+}
@@ -0,0 +1,228 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "enums.hpp"
+#include "morphology.hpp"
+#include "parallel.hpp"
+#include "simd.hpp"
+#include "view.hpp"
+
+// a pixel is a local maximum when nothing in its (2r + 1)^2 window is larger and it is above
+// the threshold; pixels outside the image are ignored, flat plateaus report every pixel
+typedef struct
+{
+    uint32_t row;
+    uint32_t col;
+    uint8_t value;
+} local_max_t;
+
+// strongest first, ties in raster order so top-N is deterministic
+bool local_max_stronger(const local_max_t &a, const local_max_t &b)
+{
+    if (a.value != b.value)
+    {
+        return a.value > b.value;
+    }
+    return (a.row != b.row) ? (a.row < b.row) : (a.col < b.col);
+}
+
+// keep the max_count strongest once a band collects twice that many, bounding memory on dense maps
+void local_max_prune(std::vector<local_max_t> &maxima, size_t max_count, bool force)
+{
+    if ((max_count == 0) || (maxima.size() <= max_count) || (!force && (maxima.size() < 2 * max_count)))
+    {
+        return;
+    }
+    std::nth_element(maxima.begin(), maxima.begin() + max_count, maxima.end(), local_max_stronger);
+    maxima.resize(max_count);
+}
+
+// candidates where the mask byte is set, rare enough that a bit loop is fine
+void local_max_push(uint32_t mask, const uint8_t *src_ptr, uint32_t y, uint32_t x, std::vector<local_max_t> &maxima)
+{
+    for (uint32_t i = 0; mask; i++, mask >>= 1)
+    {
+        if (mask & 1)
+        {
+            local_max_t max = {y, x + i, src_ptr[x + i]};
+            maxima.push_back(max);
+        }
+    }
+}
+
+// 3x3 check of one pixel, x clamped at the borders, which is the same as ignoring missing neighbours
+bool local_max3_at(const uint8_t *up, const uint8_t *mid, const uint8_t *down, uint32_t x, uint32_t width,
+                   uint8_t threshold)
+{
+    uint8_t c = mid[x];
+    if (c <= threshold)
+    {
+        return false;
+    }
+    uint32_t left = (x > 0) ? (x - 1) : 0;
+    uint32_t right = (x + 1 < width) ? (x + 1) : (width - 1);
+    uint8_t m = max_op::apply(max_op::apply(up[left], up[x]), max_op::apply(up[right], mid[left]));
+    m = max_op::apply(m, max_op::apply(max_op::apply(mid[right], down[left]), max_op::apply(down[x], down[right])));
+    return c >= m;
+}
+
+// 3x3 fused in one pass over three source rows, no intermediate image
+void local_max3_band(image_view_t src_img, uint8_t threshold, size_t max_count, uint32_t y0, uint32_t y1,
+                     std::vector<local_max_t> &maxima)
+{
+    uint32_t width = src_img.width();
+    uint32_t height = src_img.height();
+
+    for (uint32_t y = y0; y < y1; y++)
+    {
+        const uint8_t *up = src_img.row((y > 0) ? (y - 1) : 0);
+        const uint8_t *mid = src_img.row(y);
+        const uint8_t *down = src_img.row((y + 1 < height) ? (y + 1) : (height - 1));
+
+        if (local_max3_at(up, mid, down, 0, width, threshold))
+        {
+            local_max_t max = {y, 0, mid[0]};
+            maxima.push_back(max);
+        }
+
+        // interior columns, loads stay within [x - 1, x + 16]
+        uint32_t x = 1;
+#ifdef CV_SSE2
+        __m128i thr = _mm_set1_epi8((char)threshold);
+        __m128i zero = _mm_setzero_si128();
+        for (; x + 16 < width; x += 16)
+        {
+            __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i *>(mid + x));
+            __m128i m = c;
+            for (int dx = -1; dx <= 1; dx++)
+            {
+                m = _mm_max_epu8(m, _mm_loadu_si128(reinterpret_cast<const __m128i *>(up + x + dx)));
+                m = _mm_max_epu8(m, _mm_loadu_si128(reinterpret_cast<const __m128i *>(down + x + dx)));
+            }
+            m = _mm_max_epu8(m, _mm_loadu_si128(reinterpret_cast<const __m128i *>(mid + x - 1)));
+            m = _mm_max_epu8(m, _mm_loadu_si128(reinterpret_cast<const __m128i *>(mid + x + 1)));
+
+            __m128i below = _mm_cmpeq_epi8(_mm_subs_epu8(c, thr), zero);
+            uint32_t mask = _mm_movemask_epi8(_mm_andnot_si128(below, _mm_cmpeq_epi8(c, m)));
+            if (mask)
+            {
+                local_max_push(mask, mid, y, x, maxima);
+            }
+        }
+#endif
+        for (; x < width; x++)
+        {
+            if (local_max3_at(up, mid, down, x, width, threshold))
+            {
+                local_max_t max = {y, x, mid[x]};
+                maxima.push_back(max);
+            }
+        }
+        local_max_prune(maxima, max_count, false);
+    }
+}
+
+// larger radius: dilate the band plus a radius halo, maxima are where the pixel survives dilation
+void local_max_band(image_view_t src_img, uint32_t radius, uint8_t threshold, size_t max_count, uint32_t y0,
+                    uint32_t y1, std::vector<local_max_t> &maxima)
+{
+    uint32_t width = src_img.width();
+    uint32_t height = src_img.height();
+    uint32_t halo_y0 = (y0 > radius) ? (y0 - radius) : 0;
+    uint32_t halo_y1 = (y1 + radius < height) ? (y1 + radius) : height;
+
+    // clamping at a halo edge only touches rows outside every needed window
+    std::vector<uint8_t> dilated((size_t)width * (halo_y1 - halo_y0));
+    image_view_t halo_img = src_img.sub(0, halo_y0, width, halo_y1 - halo_y0);
+    image_view_t dilated_img(dilated.data(), width, halo_y1 - halo_y0, width);
+    dilate(halo_img, dilated_img, 2 * radius + 1, 2 * radius + 1, clamp);
+
+    for (uint32_t y = y0; y < y1; y++)
+    {
+        const uint8_t *src_ptr = src_img.row(y);
+        const uint8_t *max_ptr = dilated_img.row(y - halo_y0);
+        uint32_t x = 0;
+#ifdef CV_SSE2
+        __m128i thr = _mm_set1_epi8((char)threshold);
+        __m128i zero = _mm_setzero_si128();
+        for (; x + 16 <= width; x += 16)
+        {
+            __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src_ptr + x));
+            __m128i m = _mm_loadu_si128(reinterpret_cast<const __m128i *>(max_ptr + x));
+            __m128i below = _mm_cmpeq_epi8(_mm_subs_epu8(c, thr), zero);
+            uint32_t mask = _mm_movemask_epi8(_mm_andnot_si128(below, _mm_cmpeq_epi8(c, m)));
+            if (mask)
+            {
+                local_max_push(mask, src_ptr, y, x, maxima);
+            }
+        }
+#endif
+        for (; x < width; x++)
+        {
+            if ((src_ptr[x] > threshold) && (src_ptr[x] == max_ptr[x]))
+            {
+                local_max_t max = {y, x, src_ptr[x]};
+                maxima.push_back(max);
+            }
+        }
+        local_max_prune(maxima, max_count, false);
+    }
+}
+
+// every local maximum above threshold, in raster order; with max_count > 0 only the
+// max_count strongest are kept and they come back strongest first
+std::vector<local_max_t> find_local_maxima(image_view_t src_img, uint32_t radius, uint8_t threshold,
+                                           size_t max_count = 0)
+{
+    assert(radius > 0);
+
+    std::mutex mutex;
+    std::vector<std::pair<uint32_t, std::vector<local_max_t> > > bands;
+    parallel_rows(src_img.height(), [&](uint32_t y0, uint32_t y1) {
+        std::vector<local_max_t> band;
+        if (radius == 1)
+        {
+            local_max3_band(src_img, threshold, max_count, y0, y1, band);
+        }
+        else
+        {
+            local_max_band(src_img, radius, threshold, max_count, y0, y1, band);
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        bands.push_back(std::make_pair(y0, std::vector<local_max_t>()));
+        bands.back().second.swap(band);
+    });
+
+    // bands finish in any order, stitch them back top to bottom
+    std::sort(bands.begin(), bands.end(),
+              [](const std::pair<uint32_t, std::vector<local_max_t> > &a,
+                 const std::pair<uint32_t, std::vector<local_max_t> > &b) { return a.first < b.first; });
+    std::vector<local_max_t> maxima;
+    for (size_t i = 0; i < bands.size(); i++)
+    {
+        maxima.insert(maxima.end(), bands[i].second.begin(), bands[i].second.end());
+    }
+
+    if (max_count > 0)
+    {
+        local_max_prune(maxima, max_count, true);
+        std::sort(maxima.begin(), maxima.end(), local_max_stronger);
+    }
+    return maxima;
+}
+
+// any strided 8-bit matrix with addr / width / height / stride members, e.g. dsa's matrix_t
+template <typename matrix_like_t>
+std::vector<local_max_t> find_matrix_local_maxima(const matrix_like_t &matrix, uint32_t radius, uint8_t threshold,
+                                                  size_t max_count = 0)
+{
+    image_view_t view(matrix.addr, (uint32_t)matrix.width, (uint32_t)matrix.height, (uint32_t)matrix.stride);
+    return find_local_maxima(view, radius, threshold, max_count);
+}
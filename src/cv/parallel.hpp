@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <thread>
+#include <vector>
+
+// split rows [0, height) into one band per hardware thread and run fn(begin, end) on each,
+// bands smaller than min_rows are merged so tiny images stay single threaded
+void parallel_rows(uint32_t height, std::function<void(uint32_t, uint32_t)> fn, uint32_t min_rows = 32)
+{
+    uint32_t num_threads = std::thread::hardware_concurrency();
+    if (num_threads == 0)
+    {
+        num_threads = 1;
+    }
+    uint32_t max_bands = (height + min_rows - 1) / min_rows;
+    if (num_threads > max_bands)
+    {
+        num_threads = (max_bands > 0) ? max_bands : 1;
+    }
+
+    if (num_threads == 1)
+    {
+        fn(0, height);
+        return;
+    }
+
+    std::vector<std::thread> threads;
+    uint32_t band = (height + num_threads - 1) / num_threads;
+    for (uint32_t begin = 0; begin < height; begin += band)
+    {
+        uint32_t end = (begin + band < height) ? (begin + band) : height;
+        threads.push_back(std::thread(fn, begin, end));
+    }
+    for (size_t i = 0; i < threads.size(); i++)
+    {
+        threads[i].join();
+    }
+}
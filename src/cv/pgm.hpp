@@ -1,9 +1,38 @@
 #pragma once
 
+#include <algorithm>
 #include <cassert>
 #include <cstdint>
+#include <cstdio>
+#include <cstdlib>
 #include <cstring>
 #include <string>
+#include <vector>
+
+// largest image reshape() allocates, 4G pixels; anything above is treated as a corrupt header
+#define PGM_MAX_PIXELS (1ULL << 32)
+
+// crop and decimation applied while reading a P5 file: only the rows the output needs are
+// read, each over the crop columns only, and no full-size buffer is ever allocated
+typedef struct
+{
+    uint32_t x;         // crop origin in source pixels
+    uint32_t y;
+    uint32_t width;     // crop size, 0 runs to the image edge
+    uint32_t height;
+    uint32_t factor;    // output pixel per factor x factor block, a partial last block is dropped
+    bool average;       // box average of the block, otherwise its top-left pixel
+} pgm_load_t;
+
+// 64-bit seek so images larger than 2GB work on every platform
+static void pgm_seek(FILE *fp, uint64_t offset)
+{
+#ifdef _WIN32
+    _fseeki64(fp, (__int64)offset, SEEK_SET);
+#else
+    fseeko(fp, (off_t)offset, SEEK_SET);
+#endif
+}
 
 class pgm_t
 {
@@ -25,13 +54,86 @@ public:
         fclose(fp);
     };
 
+    pgm_t(const std::string &filename, const pgm_load_t &load)
+    {
+        FILE *fp;
+        fp = fopen(filename.c_str(), "rb");
+        assert(fp != NULL);
+        // every read below is a seek plus one span, buffering would only read ahead what is skipped
+        setvbuf(fp, NULL, _IONBF, 0);
+
+        char temp[3];
+        uint32_t src_width, src_height;
+        int fields = fscanf(fp, "%2s %u %u %u", temp, &src_width, &src_height, &this->_max_gray);
+        assert((fields == 4) && (strcmp(temp, "P5") == 0) && (this->_max_gray < 256));
+        fgetc(fp);
+        uint64_t data_offset = (uint64_t)ftell(fp);
+
+        uint32_t factor = load.factor;
+        // bounds compared by subtraction, x + width could wrap past src_width
+        assert((factor > 0) && (factor < 4096) && (load.x < src_width) && (load.y < src_height));
+        uint32_t crop_w = (load.width != 0) ? load.width : src_width - load.x;
+        uint32_t crop_h = (load.height != 0) ? load.height : src_height - load.y;
+        assert((crop_w <= src_width - load.x) && (crop_h <= src_height - load.y));
+        this->_width = crop_w / factor;
+        this->_height = crop_h / factor;
+        assert((this->_width > 0) && (this->_height > 0));
+        this->_ptr = reinterpret_cast<uint8_t *>(malloc((size_t)this->_height * this->_width));
+
+        // subsampling needs one source row per output row and only up to the last sampled column
+        uint32_t rows = load.average ? factor : 1;
+        uint32_t span = load.average ? this->_width * factor : (this->_width - 1) * factor + 1;
+        uint32_t area = factor * factor;
+        std::vector<uint8_t> line(span);
+        std::vector<uint32_t> sum(this->_width);
+        for (uint32_t y = 0; y < this->_height; y++)
+        {
+            uint8_t *dst = this->_ptr + (size_t)y * this->_width;
+            std::fill(sum.begin(), sum.end(), 0);
+            for (uint32_t r = 0; r < rows; r++)
+            {
+                uint64_t src_y = load.y + (uint64_t)y * factor + r;
+                pgm_seek(fp, data_offset + src_y * src_width + load.x);
+                size_t read = fread(line.data(), 1, span, fp);
+                assert(read == span);
+
+                if (!load.average)
+                {
+                    for (uint32_t x = 0; x < this->_width; x++)
+                    {
+                        dst[x] = line[x * factor];
+                    }
+                    continue;
+                }
+                for (uint32_t x = 0; x < this->_width; x++)
+                {
+                    const uint8_t *block = line.data() + x * factor;
+                    for (uint32_t i = 0; i < factor; i++)
+                    {
+                        sum[x] += block[i];
+                    }
+                }
+            }
+            if (load.average)
+            {
+                for (uint32_t x = 0; x < this->_width; x++)
+                {
+                    dst[x] = (uint8_t)((sum[x] + area / 2) / area);
+                }
+            }
+        }
+
+        fclose(fp);
+    };
+
     pgm_t(uint32_t width, uint32_t height)
     {
         this->_height = height;
         this->_width = width;
         this->_max_gray = 255;
-        this->_ptr = reinterpret_cast<uint8_t *>(malloc(this->_height * this->_width));
-        memset(this->_ptr, 0, this->_width * this->_height);
+        this->_ptr = reinterpret_cast<uint8_t *>(malloc((size_t)this->_height * this->_width));
+        assert((this->_ptr != NULL) || ((size_t)this->_height * this->_width == 0));
+        memset(this->_ptr, 0, (size_t)this->_width * this->_height);
     };
 
     ~pgm_t() { free(this->_ptr); }
@@ -66,6 +168,36 @@ public:
         fclose(fp);
     }
 
+    // resize the pixel buffer, the allocation is kept when the size does not change; false, with
+    // an empty 0 x 0 image left behind, when the size is over PGM_MAX_PIXELS or malloc fails
+    bool reshape(uint32_t width, uint32_t height)
+    {
+        if ((width == this->_width) && (height == this->_height))
+        {
+            return true;
+        }
+        free(this->_ptr);
+        this->_ptr = NULL;
+        this->_width = 0;
+        this->_height = 0;
+
+        uint64_t size = (uint64_t)width * height;
+        if ((size > PGM_MAX_PIXELS) || (size > SIZE_MAX))
+        {
+            return false;
+        }
+        uint8_t *ptr = reinterpret_cast<uint8_t *>(malloc((size_t)size));
+        if ((ptr == NULL) && (size > 0))
+        {
+            return false;
+        }
+        memset(ptr, 0, (size_t)size);
+        this->_ptr = ptr;
+        this->_width = width;
+        this->_height = height;
+        return true;
+    }
+
     uint32_t height() { return this->_height; }
     uint32_t width() { return this->_width; }
     uint32_t max_gray() { return this->_max_gray; }
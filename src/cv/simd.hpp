@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+    #include <emmintrin.h>
+    #define CV_SSE2 1
+#endif
+
+// element-wise operators usable both on single pixels and 16-lane vectors
+struct min_op
+{
+    static uint8_t apply(uint8_t a, uint8_t b) { return (a < b) ? a : b; }
+#ifdef CV_SSE2
+    static __m128i apply(__m128i a, __m128i b) { return _mm_min_epu8(a, b); }
+#endif
+};
+
+struct max_op
+{
+    static uint8_t apply(uint8_t a, uint8_t b) { return (a > b) ? a : b; }
+#ifdef CV_SSE2
+    static __m128i apply(__m128i a, __m128i b) { return _mm_max_epu8(a, b); }
+#endif
+};
+
+// dst[i] = op(a[i], b[i]), dst may alias a or b
+template <typename op_t>
+void row_apply(const uint8_t *a, const uint8_t *b, uint8_t *dst, uint32_t n)
+{
+    uint32_t i = 0;
+#ifdef CV_SSE2
+    for (; i + 16 <= n; i += 16)
+    {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), op_t::apply(va, vb));
+    }
+#endif
+    for (; i < n; i++)
+    {
+        dst[i] = op_t::apply(a[i], b[i]);
+    }
+}
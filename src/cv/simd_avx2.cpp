@@ -0,0 +1,111 @@
+// built with -mavx2 (/arch:AVX2), 32 pixels per step; unpacks and packs work per 128-bit
+// lane, every unpack is undone by a pack at the same level so pixel order is preserved
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <immintrin.h>
+
+#define SIMD_SUFFIX _avx2
+#define SIMD_NAME "avx2"
+#define VEC_BYTES 32
+#define VEC_GATHER_LANES 8
+
+typedef __m256i vec_t;
+
+static inline vec_t v_load(const uint8_t *p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)); }
+static inline void v_store(uint8_t *p, vec_t v) { _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), v); }
+static inline vec_t v_broadcast16(const uint8_t *p)
+{
+    return _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p)));
+}
+static inline vec_t v_zero() { return _mm256_setzero_si256(); }
+static inline vec_t v_set1_8(int8_t v) { return _mm256_set1_epi8(v); }
+static inline vec_t v_set1_16(int16_t v) { return _mm256_set1_epi16(v); }
+static inline vec_t v_and(vec_t a, vec_t b) { return _mm256_and_si256(a, b); }
+static inline vec_t v_or(vec_t a, vec_t b) { return _mm256_or_si256(a, b); }
+static inline vec_t v_xor(vec_t a, vec_t b) { return _mm256_xor_si256(a, b); }
+static inline vec_t v_unpacklo8(vec_t a, vec_t b) { return _mm256_unpacklo_epi8(a, b); }
+static inline vec_t v_unpackhi8(vec_t a, vec_t b) { return _mm256_unpackhi_epi8(a, b); }
+static inline vec_t v_unpacklo16(vec_t a, vec_t b) { return _mm256_unpacklo_epi16(a, b); }
+static inline vec_t v_unpackhi16(vec_t a, vec_t b) { return _mm256_unpackhi_epi16(a, b); }
+static inline vec_t v_add16(vec_t a, vec_t b) { return _mm256_add_epi16(a, b); }
+static inline vec_t v_mullo16(vec_t a, vec_t b) { return _mm256_mullo_epi16(a, b); }
+static inline vec_t v_mulhi_u16(vec_t a, vec_t b) { return _mm256_mulhi_epu16(a, b); }
+static inline vec_t v_abs16(vec_t a) { return _mm256_abs_epi16(a); }
+static inline vec_t v_srl16(vec_t a, uint32_t n) { return _mm256_srl_epi16(a, _mm_cvtsi32_si128((int)n)); }
+static inline vec_t v_adds_u8(vec_t a, vec_t b) { return _mm256_adds_epu8(a, b); }
+static inline vec_t v_shuffle8(vec_t table, vec_t index) { return _mm256_shuffle_epi8(table, index); }
+static inline vec_t v_packus16(vec_t a, vec_t b) { return _mm256_packus_epi16(a, b); }
+static inline vec_t v_packs32(vec_t a, vec_t b) { return _mm256_packs_epi32(a, b); }
+static inline vec_t v_madd16(vec_t a, vec_t b) { return _mm256_madd_epi16(a, b); }
+static inline vec_t v_srli32_1(vec_t a) { return _mm256_srli_epi32(a, 1); }
+static inline vec_t v_sqrt_trunc32(vec_t a) { return _mm256_cvttps_epi32(_mm256_sqrt_ps(_mm256_cvtepi32_ps(a))); }
+static inline vec_t v_keep_gt_u8(vec_t a, vec_t thr)
+{
+    return _mm256_andnot_si256(_mm256_cmpeq_epi8(_mm256_subs_epu8(a, thr), _mm256_setzero_si256()), a);
+}
+
+// 8 lanes of src[index] through 32-bit gathers, low byte of each kept
+static inline void v_gather_bytes(const uint8_t *src, const uint32_t *index, uint8_t *dst)
+{
+    __m256i idx = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(index));
+    __m256i g = _mm256_and_si256(_mm256_i32gather_epi32(reinterpret_cast<const int *>(src), idx, 1),
+                                 _mm256_set1_epi32(0xFF));
+    g = _mm256_packus_epi32(g, g);
+    g = _mm256_packus_epi16(g, g);
+    uint32_t lo = (uint32_t)_mm_cvtsi128_si32(_mm256_castsi256_si128(g));
+    uint32_t hi = (uint32_t)_mm_cvtsi128_si32(_mm256_extracti128_si256(g, 1));
+    memcpy(dst, &lo, 4);
+    memcpy(dst + 4, &hi, 4);
+}
+
+// 32-bit lanes, used by the gather based kernels
+static inline vec_t v_load32(const int32_t *p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)); }
+static inline vec_t v_set1_32(int32_t v) { return _mm256_set1_epi32(v); }
+static inline vec_t v_add32(vec_t a, vec_t b) { return _mm256_add_epi32(a, b); }
+static inline vec_t v_sub32(vec_t a, vec_t b) { return _mm256_sub_epi32(a, b); }
+static inline vec_t v_mullo32(vec_t a, vec_t b) { return _mm256_mullo_epi32(a, b); }
+static inline vec_t v_srai32(vec_t a, int n) { return _mm256_sra_epi32(a, _mm_cvtsi32_si128(n)); }
+static inline vec_t v_slli32(vec_t a, int n) { return _mm256_sll_epi32(a, _mm_cvtsi32_si128(n)); }
+static inline bool v_any_gt32(vec_t a, vec_t b) { return _mm256_movemask_epi8(_mm256_cmpgt_epi32(a, b)) != 0; }
+static inline vec_t v_gather32(const uint8_t *base, vec_t offset)
+{
+    return _mm256_i32gather_epi32(reinterpret_cast<const int *>(base), offset, 1);
+}
+
+// low byte of each 32-bit lane, lanes already within [0, 255]
+static inline void v_store_bytes32(uint8_t *dst, vec_t v)
+{
+    v = _mm256_packus_epi32(v, v);
+    v = _mm256_packus_epi16(v, v);
+    uint32_t lo = (uint32_t)_mm_cvtsi128_si32(_mm256_castsi256_si128(v));
+    uint32_t hi = (uint32_t)_mm_cvtsi128_si32(_mm256_extracti128_si256(v, 1));
+    memcpy(dst, &lo, 4);
+    memcpy(dst + 4, &hi, 4);
+}
+
+// 32 interleaved rgb pixels, 128-bit lane k holds the three 16-byte blocks of pixels [16k, 16k + 16)
+static inline vec_t v_load_lanes(const uint8_t *lo, const uint8_t *hi)
+{
+    return _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(lo))),
+                                   _mm_loadu_si128(reinterpret_cast<const __m128i *>(hi)), 1);
+}
+static inline void v_store_lanes(uint8_t *lo, uint8_t *hi, vec_t v)
+{
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(lo), _mm256_castsi256_si128(v));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(hi), _mm256_extracti128_si256(v, 1));
+}
+static inline void v_load_rgb(const uint8_t *p, vec_t &a, vec_t &b, vec_t &c)
+{
+    a = v_load_lanes(p, p + 48);
+    b = v_load_lanes(p + 16, p + 64);
+    c = v_load_lanes(p + 32, p + 80);
+}
+static inline void v_store_rgb(uint8_t *p, vec_t a, vec_t b, vec_t c)
+{
+    v_store_lanes(p, p + 48, a);
+    v_store_lanes(p + 16, p + 64, b);
+    v_store_lanes(p + 32, p + 80, c);
+}
+
+#include "simd_impl.hpp"
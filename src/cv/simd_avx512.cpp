@@ -0,0 +1,98 @@
+// built with -mavx512f -mavx512bw (/arch:AVX512), 64 pixels per step; compares give masks
+// instead of vectors, otherwise the same per 128-bit lane scheme as simd_avx2.cpp
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <immintrin.h>
+
+#define SIMD_SUFFIX _avx512
+#define SIMD_NAME "avx512"
+#define VEC_BYTES 64
+#define VEC_GATHER_LANES 16
+
+typedef __m512i vec_t;
+
+static inline vec_t v_load(const uint8_t *p) { return _mm512_loadu_si512(p); }
+static inline void v_store(uint8_t *p, vec_t v) { _mm512_storeu_si512(p, v); }
+static inline vec_t v_broadcast16(const uint8_t *p)
+{
+    return _mm512_broadcast_i32x4(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p)));
+}
+static inline vec_t v_zero() { return _mm512_setzero_si512(); }
+static inline vec_t v_set1_8(int8_t v) { return _mm512_set1_epi8(v); }
+static inline vec_t v_set1_16(int16_t v) { return _mm512_set1_epi16(v); }
+static inline vec_t v_and(vec_t a, vec_t b) { return _mm512_and_si512(a, b); }
+static inline vec_t v_or(vec_t a, vec_t b) { return _mm512_or_si512(a, b); }
+static inline vec_t v_xor(vec_t a, vec_t b) { return _mm512_xor_si512(a, b); }
+static inline vec_t v_unpacklo8(vec_t a, vec_t b) { return _mm512_unpacklo_epi8(a, b); }
+static inline vec_t v_unpackhi8(vec_t a, vec_t b) { return _mm512_unpackhi_epi8(a, b); }
+static inline vec_t v_unpacklo16(vec_t a, vec_t b) { return _mm512_unpacklo_epi16(a, b); }
+static inline vec_t v_unpackhi16(vec_t a, vec_t b) { return _mm512_unpackhi_epi16(a, b); }
+static inline vec_t v_add16(vec_t a, vec_t b) { return _mm512_add_epi16(a, b); }
+static inline vec_t v_mullo16(vec_t a, vec_t b) { return _mm512_mullo_epi16(a, b); }
+static inline vec_t v_mulhi_u16(vec_t a, vec_t b) { return _mm512_mulhi_epu16(a, b); }
+static inline vec_t v_abs16(vec_t a) { return _mm512_abs_epi16(a); }
+static inline vec_t v_srl16(vec_t a, uint32_t n) { return _mm512_srl_epi16(a, _mm_cvtsi32_si128((int)n)); }
+static inline vec_t v_adds_u8(vec_t a, vec_t b) { return _mm512_adds_epu8(a, b); }
+static inline vec_t v_shuffle8(vec_t table, vec_t index) { return _mm512_shuffle_epi8(table, index); }
+static inline vec_t v_packus16(vec_t a, vec_t b) { return _mm512_packus_epi16(a, b); }
+static inline vec_t v_packs32(vec_t a, vec_t b) { return _mm512_packs_epi32(a, b); }
+static inline vec_t v_madd16(vec_t a, vec_t b) { return _mm512_madd_epi16(a, b); }
+static inline vec_t v_srli32_1(vec_t a) { return _mm512_srli_epi32(a, 1); }
+static inline vec_t v_sqrt_trunc32(vec_t a) { return _mm512_cvttps_epi32(_mm512_sqrt_ps(_mm512_cvtepi32_ps(a))); }
+static inline vec_t v_keep_gt_u8(vec_t a, vec_t thr) { return _mm512_maskz_mov_epi8(_mm512_cmpgt_epu8_mask(a, thr), a); }
+
+// 16 lanes of src[index], vpmovdb narrows the gathered dwords straight to bytes
+static inline void v_gather_bytes(const uint8_t *src, const uint32_t *index, uint8_t *dst)
+{
+    __m512i idx = _mm512_loadu_si512(index);
+    __m512i g = _mm512_i32gather_epi32(idx, src, 1);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst), _mm512_cvtepi32_epi8(g));
+}
+
+// 32-bit lanes, used by the gather based kernels
+static inline vec_t v_load32(const int32_t *p) { return _mm512_loadu_si512(p); }
+static inline vec_t v_set1_32(int32_t v) { return _mm512_set1_epi32(v); }
+static inline vec_t v_add32(vec_t a, vec_t b) { return _mm512_add_epi32(a, b); }
+static inline vec_t v_sub32(vec_t a, vec_t b) { return _mm512_sub_epi32(a, b); }
+static inline vec_t v_mullo32(vec_t a, vec_t b) { return _mm512_mullo_epi32(a, b); }
+static inline vec_t v_srai32(vec_t a, int n) { return _mm512_sra_epi32(a, _mm_cvtsi32_si128(n)); }
+static inline vec_t v_slli32(vec_t a, int n) { return _mm512_sll_epi32(a, _mm_cvtsi32_si128(n)); }
+static inline bool v_any_gt32(vec_t a, vec_t b) { return _mm512_cmpgt_epi32_mask(a, b) != 0; }
+static inline vec_t v_gather32(const uint8_t *base, vec_t offset) { return _mm512_i32gather_epi32(offset, base, 1); }
+
+// low byte of each 32-bit lane, lanes already within [0, 255]
+static inline void v_store_bytes32(uint8_t *dst, vec_t v)
+{
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst), _mm512_cvtepi32_epi8(v));
+}
+
+// 64 interleaved rgb pixels, 128-bit lane k holds the three 16-byte blocks of pixels [16k, 16k + 16)
+static inline vec_t v_load_lanes(const uint8_t *p)
+{
+    vec_t v = _mm512_castsi128_si512(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p)));
+    v = _mm512_inserti32x4(v, _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 48)), 1);
+    v = _mm512_inserti32x4(v, _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 96)), 2);
+    return _mm512_inserti32x4(v, _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 144)), 3);
+}
+static inline void v_store_lanes(uint8_t *p, vec_t v)
+{
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(p), _mm512_castsi512_si128(v));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(p + 48), _mm512_extracti32x4_epi32(v, 1));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(p + 96), _mm512_extracti32x4_epi32(v, 2));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(p + 144), _mm512_extracti32x4_epi32(v, 3));
+}
+static inline void v_load_rgb(const uint8_t *p, vec_t &a, vec_t &b, vec_t &c)
+{
+    a = v_load_lanes(p);
+    b = v_load_lanes(p + 16);
+    c = v_load_lanes(p + 32);
+}
+static inline void v_store_rgb(uint8_t *p, vec_t a, vec_t b, vec_t c)
+{
+    v_store_lanes(p, a);
+    v_store_lanes(p + 16, b);
+    v_store_lanes(p + 32, c);
+}
+
+#include "simd_impl.hpp"
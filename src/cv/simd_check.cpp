@@ -0,0 +1,219 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "cpu.hpp"
+#include "dispatch.hpp"
+
+// every kernel of every level this cpu runs must match simd_kernels_scalar bit for bit;
+// widths cover empty rows, scalar-only rows and each vector width with a tail
+static const uint32_t check_widths[] = {0, 1, 3, 7, 15, 16, 17, 31, 32, 33, 63, 64, 65, 127, 129, 255, 1000};
+
+static uint32_t check_seed = 12345;
+
+static uint8_t check_random()
+{
+    check_seed = check_seed * 1103515245 + 12345;
+    return (uint8_t)(check_seed >> 16);
+}
+
+static void fill_random(std::vector<uint8_t> &buffer)
+{
+    for (size_t i = 0; i < buffer.size(); i++)
+    {
+        buffer[i] = check_random();
+    }
+}
+
+static bool report(const simd_kernels_t &kernels, const char *kernel, uint32_t width, bool same)
+{
+    if (!same)
+    {
+        fprintf(stderr, "%s: %s differs from scalar at width %u\n", kernels.name, kernel, width);
+    }
+    return same;
+}
+
+static bool check_convolve(const simd_kernels_t &kernels, const simd_kernels_t &scalar, uint32_t width)
+{
+    bool ok = true;
+    for (uint32_t k_size = 3; k_size <= 5; k_size += 2)
+    {
+        // weights small enough that the int16 sum cannot overflow
+        std::vector<int8_t> kernel(k_size * k_size);
+        for (size_t i = 0; i < kernel.size(); i++)
+        {
+            kernel[i] = (int8_t)(check_random() % 5) - 2;
+        }
+        std::vector<std::vector<uint8_t> > lines(k_size, std::vector<uint8_t>(width + k_size));
+        std::vector<const uint8_t *> rows(k_size);
+        for (uint32_t k = 0; k < k_size; k++)
+        {
+            fill_random(lines[k]);
+            rows[k] = lines[k].data();
+        }
+
+        int16_t div_factor = (int16_t)(k_size * k_size);
+        std::vector<uint8_t> expected(width + 1, 0);
+        std::vector<uint8_t> actual(width + 1, 0);
+        scalar.convolve_row(rows.data(), kernel.data(), k_size, div_factor, expected.data(), width);
+        kernels.convolve_row(rows.data(), kernel.data(), k_size, div_factor, actual.data(), width);
+        ok &= report(kernels, "convolve_row", width, expected == actual);
+    }
+    return ok;
+}
+
+static bool check_histogram(const simd_kernels_t &kernels, const simd_kernels_t &scalar, uint32_t width)
+{
+    std::vector<uint8_t> src(width);
+    fill_random(src);
+    std::vector<uint32_t> expected(256, 0);
+    std::vector<uint32_t> actual(256, 0);
+    scalar.freq_row(src.data(), width, expected.data());
+    kernels.freq_row(src.data(), width, actual.data());
+    bool ok = report(kernels, "freq_row", width, expected == actual);
+
+    std::vector<uint8_t> lut(256);
+    fill_random(lut);
+    std::vector<uint8_t> lut_expected(width + 1, 0);
+    std::vector<uint8_t> lut_actual(width + 1, 0);
+    scalar.lut_row(src.data(), lut_expected.data(), width, lut.data());
+    kernels.lut_row(src.data(), lut_actual.data(), width, lut.data());
+    return report(kernels, "lut_row", width, lut_expected == lut_actual) && ok;
+}
+
+static bool check_resize(const simd_kernels_t &kernels, const simd_kernels_t &scalar, uint32_t width)
+{
+    uint32_t src_width = width / 2 + 1;
+    std::vector<uint8_t> src(src_width);
+    fill_random(src);
+    std::vector<uint32_t> x_index(width);
+    for (uint32_t x = 0; x < width; x++)
+    {
+        x_index[x] = (uint32_t)((uint64_t)x * src_width / (width + 1));
+    }
+
+    std::vector<uint8_t> expected(width + 1, 0);
+    std::vector<uint8_t> actual(width + 1, 0);
+    scalar.resize_nearest_row(src.data(), x_index.data(), expected.data(), width, src_width);
+    kernels.resize_nearest_row(src.data(), x_index.data(), actual.data(), width, src_width);
+    return report(kernels, "resize_nearest_row", width, expected == actual);
+}
+
+static bool check_edge(const simd_kernels_t &kernels, const simd_kernels_t &scalar, uint32_t width)
+{
+    std::vector<uint8_t> gx(width);
+    std::vector<uint8_t> gy(width);
+    fill_random(gx);
+    fill_random(gy);
+    uint8_t threshold = check_random();
+
+    std::vector<uint8_t> expected(width + 1, 0);
+    std::vector<uint8_t> actual(width + 1, 0);
+    scalar.edge_rms_row(gx.data(), gy.data(), expected.data(), width, threshold);
+    kernels.edge_rms_row(gx.data(), gy.data(), actual.data(), width, threshold);
+    return report(kernels, "edge_rms_row", width, expected == actual);
+}
+
+static bool check_warp(const simd_kernels_t &kernels, const simd_kernels_t &scalar, uint32_t width)
+{
+    const uint32_t src_width = 70;
+    const uint32_t src_height = 40;
+    std::vector<uint8_t> src(src_width * src_height);
+    fill_random(src);
+
+    // samples and their right / lower neighbours inside the source
+    std::vector<int32_t> map_x(width);
+    std::vector<int32_t> map_y(width);
+    for (uint32_t x = 0; x < width; x++)
+    {
+        map_x[x] = (int32_t)((((uint32_t)check_random() << 8) | check_random()) % ((src_width - 4) << WARP_FRAC_BITS));
+        map_y[x] = (int32_t)((((uint32_t)check_random() << 8) | check_random()) % ((src_height - 4) << WARP_FRAC_BITS));
+    }
+    int32_t base = 1 << WARP_FRAC_BITS;
+
+    bool ok = true;
+    for (int bilinear = 0; bilinear < 2; bilinear++)
+    {
+        std::vector<uint8_t> expected(width + 1, 0);
+        std::vector<uint8_t> actual(width + 1, 0);
+        scalar.warp_row(src.data(), src_width, (uint32_t)src.size(), map_x.data(), map_y.data(), base, base,
+                        expected.data(), width, bilinear != 0);
+        kernels.warp_row(src.data(), src_width, (uint32_t)src.size(), map_x.data(), map_y.data(), base, base,
+                         actual.data(), width, bilinear != 0);
+        ok &= report(kernels, "warp_row", width, expected == actual);
+    }
+    return ok;
+}
+
+static bool check_color(const simd_kernels_t &kernels, const simd_kernels_t &scalar, uint32_t width)
+{
+    std::vector<uint8_t> rgb(3 * width);
+    fill_random(rgb);
+    static const uint16_t weights[3] = {9798, 19235, 3735};
+
+    std::vector<uint8_t> expected(width + 1, 0);
+    std::vector<uint8_t> actual(width + 1, 0);
+    scalar.rgb_to_gray_row(rgb.data(), expected.data(), width, weights);
+    kernels.rgb_to_gray_row(rgb.data(), actual.data(), width, weights);
+    bool ok = report(kernels, "rgb_to_gray_row", width, expected == actual);
+
+    std::vector<uint8_t> planes_expected[3];
+    std::vector<uint8_t> planes_actual[3];
+    for (int c = 0; c < 3; c++)
+    {
+        planes_expected[c].assign(width + 1, 0);
+        planes_actual[c].assign(width + 1, 0);
+    }
+    scalar.deinterleave_rgb_row(rgb.data(), planes_expected[0].data(), planes_expected[1].data(),
+                                planes_expected[2].data(), width);
+    kernels.deinterleave_rgb_row(rgb.data(), planes_actual[0].data(), planes_actual[1].data(), planes_actual[2].data(),
+                                 width);
+    bool same = true;
+    for (int c = 0; c < 3; c++)
+    {
+        same &= (planes_expected[c] == planes_actual[c]);
+    }
+    ok &= report(kernels, "deinterleave_rgb_row", width, same);
+
+    std::vector<uint8_t> rgb_expected(3 * width + 1, 0);
+    std::vector<uint8_t> rgb_actual(3 * width + 1, 0);
+    scalar.interleave_rgb_row(planes_expected[0].data(), planes_expected[1].data(), planes_expected[2].data(),
+                              rgb_expected.data(), width);
+    kernels.interleave_rgb_row(planes_expected[0].data(), planes_expected[1].data(), planes_expected[2].data(),
+                               rgb_actual.data(), width);
+    return report(kernels, "interleave_rgb_row", width, rgb_expected == rgb_actual) && ok;
+}
+
+// ./simd_check_exe, non-zero exit when any level differs from scalar
+int main()
+{
+    const simd_kernels_t &scalar = simd_kernels_scalar;
+    simd_level_e detected = detect_simd_level();
+    bool ok = true;
+    for (int level = simd_sse42; level <= detected; level++)
+    {
+        const simd_kernels_t &kernels = *simd_kernels_for((simd_level_e)level);
+        bool level_ok = true;
+        for (size_t w = 0; w < sizeof(check_widths) / sizeof(check_widths[0]); w++)
+        {
+            uint32_t width = check_widths[w];
+            level_ok &= check_convolve(kernels, scalar, width);
+            level_ok &= check_histogram(kernels, scalar, width);
+            level_ok &= check_resize(kernels, scalar, width);
+            level_ok &= check_edge(kernels, scalar, width);
+            level_ok &= check_warp(kernels, scalar, width);
+            level_ok &= check_color(kernels, scalar, width);
+        }
+        printf("%s: %s\n", kernels.name, level_ok ? "ok" : "FAILED");
+        ok &= level_ok;
+    }
+    for (int level = detected + 1; level <= simd_avx512; level++)
+    {
+        printf("%s: skipped, not supported by this cpu\n", simd_level_names[level]);
+    }
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,421 @@
+// kernel bodies shared by every simd_<level>.cpp; the including file defines SIMD_SUFFIX,
+// SIMD_NAME, VEC_BYTES (0 for scalar) and, when VEC_BYTES > 0, vec_t with the v_* wrappers.
+// Everything here is static so code built with wider instruction sets never leaks to callers.
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#include "simd_kernels.hpp"
+
+#define KERNEL_PASTE2(name, suffix) name##suffix
+#define KERNEL_PASTE(name, suffix) KERNEL_PASTE2(name, suffix)
+#define KERNEL(name) KERNEL_PASTE(name, SIMD_SUFFIX)
+
+static void KERNEL(convolve_row)(const uint8_t *const *rows, const int8_t *kernel, uint32_t k_size,
+                                 int16_t div_factor, uint8_t *dst, uint32_t width)
+{
+    uint32_t x = 0;
+
+#if VEC_BYTES
+    // |sum| / d as a multiply-high: with l = ceil(log2 d) and m = ceil(2^(15 + l) / d),
+    // (|sum| * m) >> (15 + l) is exact for every |sum| <= 2^15
+    uint32_t d = (uint32_t)abs(div_factor);
+    uint32_t l = 0;
+    while ((1u << l) < d)
+    {
+        l++;
+    }
+    vec_t magic = v_set1_16((int16_t)(uint16_t)(((1u << (15 + l)) + d - 1) / d));
+    vec_t zero = v_zero();
+    vec_t low_byte = v_set1_16(0xFF);
+
+    for (; x + VEC_BYTES <= width; x += VEC_BYTES)
+    {
+        vec_t sum_lo = zero;
+        vec_t sum_hi = zero;
+        for (uint32_t k_y = 0; k_y < k_size; k_y++)
+        {
+            for (uint32_t k_x = 0; k_x < k_size; k_x++)
+            {
+                int8_t k = kernel[k_y * k_size + k_x];
+                if (k == 0)
+                {
+                    continue;
+                }
+                vec_t k_vec = v_set1_16(k);
+                vec_t p = v_load(rows[k_y] + x + k_x);
+                sum_lo = v_add16(sum_lo, v_mullo16(v_unpacklo8(p, zero), k_vec));
+                sum_hi = v_add16(sum_hi, v_mullo16(v_unpackhi8(p, zero), k_vec));
+            }
+        }
+
+        vec_t q_lo = v_abs16(sum_lo);
+        vec_t q_hi = v_abs16(sum_hi);
+        if (d > 1)
+        {
+            q_lo = v_srl16(v_mulhi_u16(q_lo, magic), l - 1);
+            q_hi = v_srl16(v_mulhi_u16(q_hi, magic), l - 1);
+        }
+        v_store(dst + x, v_packus16(v_and(q_lo, low_byte), v_and(q_hi, low_byte)));
+    }
+#endif
+
+    for (; x < width; x++)
+    {
+        int16_t sum = 0;
+        for (uint32_t k_y = 0; k_y < k_size; k_y++)
+        {
+            for (uint32_t k_x = 0; k_x < k_size; k_x++)
+            {
+                sum += rows[k_y][x + k_x] * kernel[k_y * k_size + k_x];
+            }
+        }
+        dst[x] = (uint8_t)(abs(sum / div_factor));
+    }
+}
+
+static void KERNEL(freq_row)(const uint8_t *src, uint32_t n, uint32_t *freq)
+{
+    // freq is the first of four tables; flat regions would otherwise increment one counter back to back
+    uint32_t sub[3][256];
+    memset(sub, 0, sizeof(sub));
+    uint32_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        freq[src[i]]++;
+        sub[0][src[i + 1]]++;
+        sub[1][src[i + 2]]++;
+        sub[2][src[i + 3]]++;
+    }
+    for (; i < n; i++)
+    {
+        freq[src[i]]++;
+    }
+    for (uint32_t v = 0; v < 256; v++)
+    {
+        freq[v] += sub[0][v] + sub[1][v] + sub[2][v];
+    }
+}
+
+static void KERNEL(lut_row)(const uint8_t *src, uint8_t *dst, uint32_t n, const uint8_t *lut)
+{
+    uint32_t i = 0;
+
+#if VEC_BYTES
+    // 16 byte shuffles, one per high nibble; adding 0x70 with saturation sets bit 7 (shuffle
+    // gives 0) whenever the high nibble does not match the table
+    vec_t tables[16];
+    for (int t = 0; t < 16; t++)
+    {
+        tables[t] = v_broadcast16(lut + 16 * t);
+    }
+    vec_t bias = v_set1_8(0x70);
+    for (; i + VEC_BYTES <= n; i += VEC_BYTES)
+    {
+        vec_t v = v_load(src + i);
+        vec_t result = v_zero();
+        for (int t = 0; t < 16; t++)
+        {
+            vec_t index = v_adds_u8(v_xor(v, v_set1_8((int8_t)(t << 4))), bias);
+            result = v_or(result, v_shuffle8(tables[t], index));
+        }
+        v_store(dst + i, result);
+    }
+#endif
+
+    for (; i < n; i++)
+    {
+        dst[i] = lut[src[i]];
+    }
+}
+
+static void KERNEL(resize_nearest_row)(const uint8_t *src, const uint32_t *x_index, uint8_t *dst, uint32_t width,
+                                       uint32_t src_width)
+{
+    uint32_t x = 0;
+
+#if VEC_GATHER_LANES
+    // gathers read 4 bytes per lane, stop while the last lane still stays inside the row
+    for (; (x + VEC_GATHER_LANES <= width) && (x_index[x + VEC_GATHER_LANES - 1] + 4 <= src_width);
+         x += VEC_GATHER_LANES)
+    {
+        v_gather_bytes(src, x_index + x, dst + x);
+    }
+#else
+    (void)src_width;
+#endif
+
+    for (; x < width; x++)
+    {
+        dst[x] = src[x_index[x]];
+    }
+}
+
+static void KERNEL(edge_rms_row)(const uint8_t *gx, const uint8_t *gy, uint8_t *dst, uint32_t n, uint8_t threshold)
+{
+    uint32_t i = 0;
+
+#if VEC_BYTES
+    // float sqrt is exact here: below 2^16 no root of a non-square is within float precision
+    // of the next integer, so truncation matches the scalar double path
+    vec_t zero = v_zero();
+    vec_t thr = v_set1_8((int8_t)threshold);
+    for (; i + VEC_BYTES <= n; i += VEC_BYTES)
+    {
+        vec_t x = v_load(gx + i);
+        vec_t y = v_load(gy + i);
+        vec_t x_lo = v_unpacklo8(x, zero);
+        vec_t x_hi = v_unpackhi8(x, zero);
+        vec_t y_lo = v_unpacklo8(y, zero);
+        vec_t y_hi = v_unpackhi8(y, zero);
+
+        // (x, y) word pairs, madd gives x^2 + y^2 per 32-bit lane
+        vec_t xy[4] = {v_unpacklo16(x_lo, y_lo), v_unpackhi16(x_lo, y_lo), v_unpacklo16(x_hi, y_hi),
+                       v_unpackhi16(x_hi, y_hi)};
+        vec_t rms[4];
+        for (int k = 0; k < 4; k++)
+        {
+            rms[k] = v_sqrt_trunc32(v_srli32_1(v_madd16(xy[k], xy[k])));
+        }
+
+        vec_t result = v_packus16(v_packs32(rms[0], rms[1]), v_packs32(rms[2], rms[3]));
+        v_store(dst + i, v_keep_gt_u8(result, thr));
+    }
+#endif
+
+    for (; i < n; i++)
+    {
+        uint8_t x_val = gx[i];
+        uint8_t y_val = gy[i];
+
+        uint8_t rms = sqrt((x_val * x_val + y_val * y_val) / 2);
+        dst[i] = (rms > threshold) ? ((uint8_t)rms) : (0);
+    }
+}
+
+static inline uint8_t KERNEL(warp_pixel)(const uint8_t *src, uint32_t src_stride, int32_t x_fixed, int32_t y_fixed,
+                                         bool bilinear)
+{
+    if (!bilinear)
+    {
+        int32_t half = 1 << (WARP_FRAC_BITS - 1);
+        return src[((y_fixed + half) >> WARP_FRAC_BITS) * src_stride + ((x_fixed + half) >> WARP_FRAC_BITS)];
+    }
+
+    // 8-bit weights, rows blended first and rounded once at the end
+    const uint8_t *p = src + (y_fixed >> WARP_FRAC_BITS) * src_stride + (x_fixed >> WARP_FRAC_BITS);
+    int32_t fx = (x_fixed >> (WARP_FRAC_BITS - 8)) & 0xFF;
+    int32_t fy = (y_fixed >> (WARP_FRAC_BITS - 8)) & 0xFF;
+    int32_t top = (p[0] << 8) + (p[1] - p[0]) * fx;
+    int32_t bottom = (p[src_stride] << 8) + (p[src_stride + 1] - p[src_stride]) * fx;
+    return (uint8_t)(((top << 8) + (bottom - top) * fy + (1 << 15)) >> 16);
+}
+
+static void KERNEL(warp_row)(const uint8_t *src, uint32_t src_stride, uint32_t src_size, const int32_t *map_x,
+                             const int32_t *map_y, int32_t base_x, int32_t base_y, uint8_t *dst, uint32_t n,
+                             bool bilinear)
+{
+    uint32_t x = 0;
+
+#if VEC_GATHER_LANES
+    // gathers read 4 bytes per lane (twice, one row apart, for bilinear); a vector reaching past
+    // the end of the image takes the scalar path
+    int64_t last = (int64_t)src_size - 4 - (bilinear ? src_stride : 0);
+    vec_t limit = v_set1_32((int32_t)((last < 0) ? -1 : last));
+    vec_t stride = v_set1_32((int32_t)src_stride);
+    vec_t bx = v_set1_32(base_x);
+    vec_t by = v_set1_32(base_y);
+    vec_t low_byte = v_set1_32(0xFF);
+    vec_t half = v_set1_32(1 << (WARP_FRAC_BITS - 1));
+    vec_t round = v_set1_32(1 << 15);
+    for (; x + VEC_GATHER_LANES <= n; x += VEC_GATHER_LANES)
+    {
+        vec_t x_fixed = v_add32(v_load32(map_x + x), bx);
+        vec_t y_fixed = v_add32(v_load32(map_y + x), by);
+        if (!bilinear)
+        {
+            x_fixed = v_add32(x_fixed, half);
+            y_fixed = v_add32(y_fixed, half);
+        }
+        vec_t offset = v_add32(v_mullo32(v_srai32(y_fixed, WARP_FRAC_BITS), stride), v_srai32(x_fixed, WARP_FRAC_BITS));
+        if (v_any_gt32(offset, limit))
+        {
+            for (uint32_t i = x; i < x + VEC_GATHER_LANES; i++)
+            {
+                dst[i] = KERNEL(warp_pixel)(src, src_stride, map_x[i] + base_x, map_y[i] + base_y, bilinear);
+            }
+            continue;
+        }
+
+        vec_t g0 = v_gather32(src, offset);
+        if (!bilinear)
+        {
+            v_store_bytes32(dst + x, v_and(g0, low_byte));
+            continue;
+        }
+
+        vec_t g1 = v_gather32(src + src_stride, offset);
+        vec_t fx = v_and(v_srai32(x_fixed, WARP_FRAC_BITS - 8), low_byte);
+        vec_t fy = v_and(v_srai32(y_fixed, WARP_FRAC_BITS - 8), low_byte);
+        vec_t p00 = v_and(g0, low_byte);
+        vec_t p01 = v_and(v_srai32(g0, 8), low_byte);
+        vec_t p10 = v_and(g1, low_byte);
+        vec_t p11 = v_and(v_srai32(g1, 8), low_byte);
+        vec_t top = v_add32(v_slli32(p00, 8), v_mullo32(v_sub32(p01, p00), fx));
+        vec_t bottom = v_add32(v_slli32(p10, 8), v_mullo32(v_sub32(p11, p10), fx));
+        vec_t blend = v_add32(v_add32(v_slli32(top, 8), v_mullo32(v_sub32(bottom, top), fy)), round);
+        v_store_bytes32(dst + x, v_srai32(blend, 16));
+    }
+#else
+    (void)src_size;
+#endif
+
+    for (; x < n; x++)
+    {
+        dst[x] = KERNEL(warp_pixel)(src, src_stride, map_x[x] + base_x, map_y[x] + base_y, bilinear);
+    }
+}
+
+#if VEC_BYTES
+// pshufb masks for 16 pixels = 48 bytes held in three 16-byte blocks per 128-bit lane:
+// deinterleave[ch][block] picks channel ch out of one block, interleave[block][ch] places
+// channel ch into one output block, 0x80 selects zero
+static void KERNEL(rgb_shuffle_masks)(vec_t deinterleave[3][3], vec_t interleave[3][3])
+{
+    uint8_t mask[16];
+    for (int ch = 0; ch < 3; ch++)
+    {
+        for (int block = 0; block < 3; block++)
+        {
+            for (int i = 0; i < 16; i++)
+            {
+                int pos = 3 * i + ch;
+                mask[i] = (pos / 16 == block) ? (uint8_t)(pos % 16) : 0x80;
+            }
+            deinterleave[ch][block] = v_broadcast16(mask);
+
+            for (int j = 0; j < 16; j++)
+            {
+                int pos = 16 * block + j;
+                mask[j] = (pos % 3 == ch) ? (uint8_t)(pos / 3) : 0x80;
+            }
+            interleave[block][ch] = v_broadcast16(mask);
+        }
+    }
+}
+
+static inline vec_t KERNEL(rgb_channel)(const vec_t masks[3], vec_t a, vec_t b, vec_t c)
+{
+    return v_or(v_or(v_shuffle8(a, masks[0]), v_shuffle8(b, masks[1])), v_shuffle8(c, masks[2]));
+}
+#endif
+
+static void KERNEL(rgb_to_gray_row)(const uint8_t *rgb, uint8_t *gray, uint32_t n, const uint16_t *weights)
+{
+    uint32_t i = 0;
+
+#if VEC_BYTES
+    vec_t deinterleave[3][3];
+    vec_t interleave[3][3];
+    KERNEL(rgb_shuffle_masks)(deinterleave, interleave);
+
+    // (r, g) and (b, 1) word pairs, one madd each gives r * wr + g * wg and b * wb + 2^14
+    vec_t zero = v_zero();
+    vec_t one = v_set1_16(1);
+    vec_t w_rg = v_set1_32((int32_t)(((uint32_t)weights[1] << 16) | weights[0]));
+    vec_t w_b = v_set1_32((int32_t)((1u << 30) | weights[2]));
+    for (; i + VEC_BYTES <= n; i += VEC_BYTES)
+    {
+        vec_t a, b, c;
+        v_load_rgb(rgb + 3 * i, a, b, c);
+        vec_t r = KERNEL(rgb_channel)(deinterleave[0], a, b, c);
+        vec_t g = KERNEL(rgb_channel)(deinterleave[1], a, b, c);
+        vec_t bl = KERNEL(rgb_channel)(deinterleave[2], a, b, c);
+
+        vec_t words[3][2] = {{v_unpacklo8(r, zero), v_unpackhi8(r, zero)},
+                             {v_unpacklo8(g, zero), v_unpackhi8(g, zero)},
+                             {v_unpacklo8(bl, zero), v_unpackhi8(bl, zero)}};
+        vec_t sums[4];
+        for (int k = 0; k < 4; k++)
+        {
+            vec_t rw = words[0][k / 2];
+            vec_t gw = words[1][k / 2];
+            vec_t bw = words[2][k / 2];
+            vec_t rg = (k % 2) ? v_unpackhi16(rw, gw) : v_unpacklo16(rw, gw);
+            vec_t b1 = (k % 2) ? v_unpackhi16(bw, one) : v_unpacklo16(bw, one);
+            sums[k] = v_srai32(v_add32(v_madd16(rg, w_rg), v_madd16(b1, w_b)), 15);
+        }
+        v_store(gray + i, v_packus16(v_packs32(sums[0], sums[1]), v_packs32(sums[2], sums[3])));
+    }
+#endif
+
+    for (; i < n; i++)
+    {
+        const uint8_t *p = rgb + 3 * i;
+        gray[i] = (uint8_t)((p[0] * weights[0] + p[1] * weights[1] + p[2] * weights[2] + (1 << 14)) >> 15);
+    }
+}
+
+static void KERNEL(deinterleave_rgb_row)(const uint8_t *rgb, uint8_t *r, uint8_t *g, uint8_t *b, uint32_t n)
+{
+    uint32_t i = 0;
+
+#if VEC_BYTES
+    vec_t deinterleave[3][3];
+    vec_t interleave[3][3];
+    KERNEL(rgb_shuffle_masks)(deinterleave, interleave);
+    for (; i + VEC_BYTES <= n; i += VEC_BYTES)
+    {
+        vec_t va, vb, vc;
+        v_load_rgb(rgb + 3 * i, va, vb, vc);
+        v_store(r + i, KERNEL(rgb_channel)(deinterleave[0], va, vb, vc));
+        v_store(g + i, KERNEL(rgb_channel)(deinterleave[1], va, vb, vc));
+        v_store(b + i, KERNEL(rgb_channel)(deinterleave[2], va, vb, vc));
+    }
+#endif
+
+    for (; i < n; i++)
+    {
+        r[i] = rgb[3 * i];
+        g[i] = rgb[3 * i + 1];
+        b[i] = rgb[3 * i + 2];
+    }
+}
+
+static void KERNEL(interleave_rgb_row)(const uint8_t *r, const uint8_t *g, const uint8_t *b, uint8_t *rgb, uint32_t n)
+{
+    uint32_t i = 0;
+
+#if VEC_BYTES
+    vec_t deinterleave[3][3];
+    vec_t interleave[3][3];
+    KERNEL(rgb_shuffle_masks)(deinterleave, interleave);
+    for (; i + VEC_BYTES <= n; i += VEC_BYTES)
+    {
+        vec_t vr = v_load(r + i);
+        vec_t vg = v_load(g + i);
+        vec_t vb = v_load(b + i);
+        v_store_rgb(rgb + 3 * i, KERNEL(rgb_channel)(interleave[0], vr, vg, vb),
+                    KERNEL(rgb_channel)(interleave[1], vr, vg, vb), KERNEL(rgb_channel)(interleave[2], vr, vg, vb));
+    }
+#endif
+
+    for (; i < n; i++)
+    {
+        rgb[3 * i] = r[i];
+        rgb[3 * i + 1] = g[i];
+        rgb[3 * i + 2] = b[i];
+    }
+}
+
+extern const simd_kernels_t KERNEL(simd_kernels) = {SIMD_NAME,
+                                                    KERNEL(convolve_row),
+                                                    KERNEL(freq_row),
+                                                    KERNEL(lut_row),
+                                                    KERNEL(resize_nearest_row),
+                                                    KERNEL(edge_rms_row),
+                                                    KERNEL(warp_row),
+                                                    KERNEL(rgb_to_gray_row),
+                                                    KERNEL(deinterleave_rgb_row),
+                                                    KERNEL(interleave_rgb_row)};
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+
+// fraction bits of the fixed-point source coordinates used by warp_row
+#define WARP_FRAC_BITS 10
+
+// row kernels built once per instruction set (simd_<level>.cpp, each with its own compiler
+// flags) and bound at startup by simd_kernels() in dispatch.hpp
+typedef struct
+{
+    const char *name;
+
+    // rows[k_y][x + k_x] is the source pixel at (x + k_x - k_size / 2), padding already applied;
+    // dst[x] = |sum / div_factor| truncated to 8 bits, sum accumulated in int16 like convolve()
+    void (*convolve_row)(const uint8_t *const *rows, const int8_t *kernel, uint32_t k_size, int16_t div_factor,
+                         uint8_t *dst, uint32_t width);
+
+    // freq[256] += counts of src[0, n)
+    void (*freq_row)(const uint8_t *src, uint32_t n, uint32_t *freq);
+
+    // dst[i] = lut[src[i]], dst may alias src
+    void (*lut_row)(const uint8_t *src, uint8_t *dst, uint32_t n, const uint8_t *lut);
+
+    // dst[x] = src[x_index[x]], x_index non-decreasing and below src_width
+    void (*resize_nearest_row)(const uint8_t *src, const uint32_t *x_index, uint8_t *dst, uint32_t width,
+                               uint32_t src_width);
+
+    // dst[i] = sqrt((gx^2 + gy^2) / 2) when above threshold, else 0
+    void (*edge_rms_row)(const uint8_t *gx, const uint8_t *gy, uint8_t *dst, uint32_t n, uint8_t threshold);
+
+    // dst[x] sampled at fixed-point (map_x[x] + base_x, map_y[x] + base_y), nearest or bilinear;
+    // every sample and its bilinear neighbours must lie inside the src_size bytes at src
+    void (*warp_row)(const uint8_t *src, uint32_t src_stride, uint32_t src_size, const int32_t *map_x,
+                     const int32_t *map_y, int32_t base_x, int32_t base_y, uint8_t *dst, uint32_t n, bool bilinear);
+
+    // gray[i] = (r * weights[0] + g * weights[1] + b * weights[2] + 2^14) >> 15 over n interleaved
+    // rgb pixels, weights in Q15 and below 2^15 each
+    void (*rgb_to_gray_row)(const uint8_t *rgb, uint8_t *gray, uint32_t n, const uint16_t *weights);
+
+    // n interleaved rgb pixels to three planes and back
+    void (*deinterleave_rgb_row)(const uint8_t *rgb, uint8_t *r, uint8_t *g, uint8_t *b, uint32_t n);
+    void (*interleave_rgb_row)(const uint8_t *r, const uint8_t *g, const uint8_t *b, uint8_t *rgb, uint32_t n);
+} simd_kernels_t;
+
+extern const simd_kernels_t simd_kernels_scalar;
+extern const simd_kernels_t simd_kernels_sse42;
+extern const simd_kernels_t simd_kernels_avx2;
+extern const simd_kernels_t simd_kernels_avx512;
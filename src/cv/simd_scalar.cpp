@@ -0,0 +1,9 @@
+// plain C++ kernels, no instruction set flags
+#include <cmath>
+
+#define SIMD_SUFFIX _scalar
+#define SIMD_NAME "scalar"
+#define VEC_BYTES 0
+#define VEC_GATHER_LANES 0
+
+#include "simd_impl.hpp"
@@ -0,0 +1,62 @@
+// built with -msse4.2 (SSSE3 shuffles, SSE4.1 packus_epi32 not needed), 16 pixels per step
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <nmmintrin.h>
+
+#define SIMD_SUFFIX _sse42
+#define SIMD_NAME "sse42"
+#define VEC_BYTES 16
+#define VEC_GATHER_LANES 0
+
+typedef __m128i vec_t;
+
+static inline vec_t v_load(const uint8_t *p) { return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p)); }
+static inline void v_store(uint8_t *p, vec_t v) { _mm_storeu_si128(reinterpret_cast<__m128i *>(p), v); }
+static inline vec_t v_broadcast16(const uint8_t *p) { return v_load(p); }
+static inline vec_t v_zero() { return _mm_setzero_si128(); }
+static inline vec_t v_set1_8(int8_t v) { return _mm_set1_epi8(v); }
+static inline vec_t v_set1_16(int16_t v) { return _mm_set1_epi16(v); }
+static inline vec_t v_and(vec_t a, vec_t b) { return _mm_and_si128(a, b); }
+static inline vec_t v_or(vec_t a, vec_t b) { return _mm_or_si128(a, b); }
+static inline vec_t v_xor(vec_t a, vec_t b) { return _mm_xor_si128(a, b); }
+static inline vec_t v_unpacklo8(vec_t a, vec_t b) { return _mm_unpacklo_epi8(a, b); }
+static inline vec_t v_unpackhi8(vec_t a, vec_t b) { return _mm_unpackhi_epi8(a, b); }
+static inline vec_t v_unpacklo16(vec_t a, vec_t b) { return _mm_unpacklo_epi16(a, b); }
+static inline vec_t v_unpackhi16(vec_t a, vec_t b) { return _mm_unpackhi_epi16(a, b); }
+static inline vec_t v_add16(vec_t a, vec_t b) { return _mm_add_epi16(a, b); }
+static inline vec_t v_mullo16(vec_t a, vec_t b) { return _mm_mullo_epi16(a, b); }
+static inline vec_t v_mulhi_u16(vec_t a, vec_t b) { return _mm_mulhi_epu16(a, b); }
+static inline vec_t v_abs16(vec_t a) { return _mm_abs_epi16(a); }
+static inline vec_t v_srl16(vec_t a, uint32_t n) { return _mm_srl_epi16(a, _mm_cvtsi32_si128((int)n)); }
+static inline vec_t v_adds_u8(vec_t a, vec_t b) { return _mm_adds_epu8(a, b); }
+static inline vec_t v_shuffle8(vec_t table, vec_t index) { return _mm_shuffle_epi8(table, index); }
+static inline vec_t v_packus16(vec_t a, vec_t b) { return _mm_packus_epi16(a, b); }
+static inline vec_t v_packs32(vec_t a, vec_t b) { return _mm_packs_epi32(a, b); }
+static inline vec_t v_madd16(vec_t a, vec_t b) { return _mm_madd_epi16(a, b); }
+static inline vec_t v_srli32_1(vec_t a) { return _mm_srli_epi32(a, 1); }
+static inline vec_t v_sqrt_trunc32(vec_t a) { return _mm_cvttps_epi32(_mm_sqrt_ps(_mm_cvtepi32_ps(a))); }
+static inline vec_t v_keep_gt_u8(vec_t a, vec_t thr)
+{
+    return _mm_andnot_si128(_mm_cmpeq_epi8(_mm_subs_epu8(a, thr), _mm_setzero_si128()), a);
+}
+
+static inline vec_t v_set1_32(int32_t v) { return _mm_set1_epi32(v); }
+static inline vec_t v_add32(vec_t a, vec_t b) { return _mm_add_epi32(a, b); }
+static inline vec_t v_srai32(vec_t a, int n) { return _mm_sra_epi32(a, _mm_cvtsi32_si128(n)); }
+
+// 16 interleaved rgb pixels as three consecutive 16-byte blocks
+static inline void v_load_rgb(const uint8_t *p, vec_t &a, vec_t &b, vec_t &c)
+{
+    a = v_load(p);
+    b = v_load(p + 16);
+    c = v_load(p + 32);
+}
+static inline void v_store_rgb(uint8_t *p, vec_t a, vec_t b, vec_t c)
+{
+    v_store(p, a);
+    v_store(p + 16, b);
+    v_store(p + 32, c);
+}
+
+#include "simd_impl.hpp"
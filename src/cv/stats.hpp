@@ -0,0 +1,148 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+
+#include "dispatch.hpp"
+#include "enums.hpp"
+#include "parallel.hpp"
+#include "view.hpp"
+
+// everything a threshold picker needs, gathered in one pass
+typedef struct
+{
+    uint64_t count;
+    uint8_t min;
+    uint8_t max;
+    uint64_t sum;
+    uint64_t sum_sq;
+    uint32_t hist[256];
+} image_stats_t;
+
+// min / max / sum / sum of squares are exact functions of the histogram, so they cost 256
+// steps here instead of extra work per pixel
+void stats_from_hist(image_stats_t &stats)
+{
+    stats.count = 0;
+    stats.sum = 0;
+    stats.sum_sq = 0;
+    stats.min = 255;
+    stats.max = 0;
+    for (uint32_t v = 0; v < 256; v++)
+    {
+        uint64_t n = stats.hist[v];
+        if (n == 0)
+        {
+            continue;
+        }
+        if (stats.count == 0)
+        {
+            stats.min = (uint8_t)v;
+        }
+        stats.max = (uint8_t)v;
+        stats.count += n;
+        stats.sum += n * v;
+        stats.sum_sq += n * v * v;
+    }
+}
+
+// one read of every pixel, bands histogrammed in parallel with the dispatched freq_row kernel
+image_stats_t image_stats(image_view_t img)
+{
+    image_stats_t stats;
+    memset(stats.hist, 0, sizeof(stats.hist));
+
+    const simd_kernels_t &kernels = simd_kernels();
+    std::mutex mutex;
+    parallel_rows(img.height(), [&](uint32_t y0, uint32_t y1) {
+        uint32_t hist[256] = {0};
+        for (uint32_t y = y0; y < y1; y++)
+        {
+            kernels.freq_row(img.row(y), img.width(), hist);
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        for (uint32_t v = 0; v < 256; v++)
+        {
+            stats.hist[v] += hist[v];
+        }
+    });
+
+    stats_from_hist(stats);
+    return stats;
+}
+
+// pixels above the returned value are foreground, same convention as edgeRms()
+
+// Otsu: the split that maximizes the between-class variance
+uint8_t otsu_threshold(const image_stats_t &stats)
+{
+    double total_sum = (double)stats.sum;
+    double best = -1;
+    uint8_t threshold = stats.min;
+    uint64_t w0 = 0;
+    double sum0 = 0;
+    for (uint32_t t = stats.min; t < stats.max; t++)
+    {
+        w0 += stats.hist[t];
+        sum0 += (double)t * stats.hist[t];
+        if (w0 == 0)
+        {
+            continue;
+        }
+        uint64_t w1 = stats.count - w0;
+        double mean_diff = sum0 / w0 - (total_sum - sum0) / w1;
+        double between = (double)w0 * (double)w1 * mean_diff * mean_diff;
+        if (between > best)
+        {
+            best = between;
+            threshold = (uint8_t)t;
+        }
+    }
+    return threshold;
+}
+
+// triangle: line from the histogram peak to the far end of the longer tail, the threshold is
+// the bin lying furthest below it; suits one dominant peak such as edge magnitudes
+uint8_t triangle_threshold(const image_stats_t &stats)
+{
+    uint32_t peak = stats.min;
+    for (uint32_t v = stats.min; v <= stats.max; v++)
+    {
+        if (stats.hist[v] > stats.hist[peak])
+        {
+            peak = v;
+        }
+    }
+    if (stats.min == stats.max)
+    {
+        return stats.min;
+    }
+
+    bool right_tail = (stats.max - peak) >= (peak - stats.min);
+    int end = right_tail ? stats.max : stats.min;
+    int step = right_tail ? 1 : -1;
+    double peak_height = stats.hist[peak];
+    double span = right_tail ? (end - (int)peak) : ((int)peak - end);
+
+    // distance to the line scaled by a constant, positive below it
+    double best = -1;
+    uint8_t threshold = (uint8_t)peak;
+    for (int v = peak; v != end + step; v += step)
+    {
+        double run = right_tail ? (end - v) : (v - end);
+        double gap = peak_height * run - span * stats.hist[v];
+        if (gap > best)
+        {
+            best = gap;
+            threshold = (uint8_t)v;
+        }
+    }
+    return threshold;
+}
+
+uint8_t auto_threshold(const image_stats_t &stats, threshold_e method)
+{
+    return (method == triangle) ? triangle_threshold(stats) : otsu_threshold(stats);
+}
@@ -0,0 +1,203 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cctype>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#include "pgm.hpp"
+
+// frames in flight: one being read, one being processed, one being written
+#define STREAM_SLOTS 3
+
+// next header number, skipping whitespace and '#' comments; consumes the single
+// delimiter after the digits so the pixel data starts right after max_gray
+static bool stream_read_uint(FILE *fp, uint32_t &val)
+{
+    int c = getc(fp);
+    while ((c != EOF) && (isspace(c) || (c == '#')))
+    {
+        if (c == '#')
+        {
+            while ((c != EOF) && (c != '\n'))
+            {
+                c = getc(fp);
+            }
+        }
+        c = getc(fp);
+    }
+    if ((c == EOF) || !isdigit(c))
+    {
+        return false;
+    }
+
+    val = 0;
+    while ((c != EOF) && isdigit(c))
+    {
+        val = val * 10 + (c - '0');
+        c = getc(fp);
+    }
+    return true;
+}
+
+// read the next P5 frame of a concatenated stream into frame, reusing its buffer when the size matches
+bool pgm_read_frame(FILE *fp, pgm_t &frame)
+{
+    int c = getc(fp);
+    while ((c != EOF) && isspace(c))
+    {
+        c = getc(fp);
+    }
+    if (c == EOF)
+    {
+        return false;
+    }
+    int c2 = getc(fp);
+    assert((c == 'P') && (c2 == '5'));
+
+    uint32_t width, height, max_gray;
+    if (!stream_read_uint(fp, width) || !stream_read_uint(fp, height) || !stream_read_uint(fp, max_gray))
+    {
+        return false;
+    }
+    assert(max_gray < 256);
+
+    if (!frame.reshape(width, height))
+    {
+        return false;
+    }
+    size_t size = (size_t)width * height;
+    return fread(frame.ptr(), 1, size, fp) == size;
+}
+
+void pgm_write_frame(FILE *fp, pgm_t &frame)
+{
+    fprintf(fp, "P5\n%d %d\n%d\n", frame.width(), frame.height(), frame.max_gray());
+    fwrite(frame.ptr(), (size_t)frame.width() * frame.height(), 1, fp);
+    fflush(fp);
+}
+
+class frame_queue_t
+{
+public:
+    frame_queue_t() { this->_closed = false; }
+
+    void push(int slot)
+    {
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        this->_slots.push(slot);
+        this->_cond.notify_one();
+    }
+
+    // blocks until a slot is available, returns -1 once closed and drained
+    int pop()
+    {
+        std::unique_lock<std::mutex> lock(this->_mutex);
+        while (this->_slots.empty() && !this->_closed)
+        {
+            this->_cond.wait(lock);
+        }
+        if (this->_slots.empty())
+        {
+            return -1;
+        }
+        int slot = this->_slots.front();
+        this->_slots.pop();
+        return slot;
+    }
+
+    void close()
+    {
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        this->_closed = true;
+        this->_cond.notify_all();
+    }
+
+private:
+    std::mutex _mutex;
+    std::condition_variable _cond;
+    std::queue<int> _slots;
+    bool _closed;
+};
+
+struct stream_slot_t
+{
+    stream_slot_t() : src(0, 0), dst(0, 0) {}
+
+    pgm_t src;
+    pgm_t dst;
+    std::chrono::steady_clock::time_point arrival;
+};
+
+// read -> process -> write pipeline over a stream of frames; reading and writing run on their
+// own threads so the three stages overlap. process must size dst itself (dst.reshape) and
+// should keep any intermediate buffers across calls.
+void run_stream(FILE *in_fp, FILE *out_fp, std::function<void(pgm_t &, pgm_t &)> process)
+{
+    stream_slot_t slots[STREAM_SLOTS];
+    frame_queue_t free_slots, read_slots, done_slots;
+    std::vector<double> latency_ms;
+
+    for (int i = 0; i < STREAM_SLOTS; i++)
+    {
+        free_slots.push(i);
+    }
+
+    std::thread reader([&]() {
+        int slot;
+        while ((slot = free_slots.pop()) >= 0)
+        {
+            if (!pgm_read_frame(in_fp, slots[slot].src))
+            {
+                break;
+            }
+            slots[slot].arrival = std::chrono::steady_clock::now();
+            read_slots.push(slot);
+        }
+        read_slots.close();
+    });
+
+    std::thread writer([&]() {
+        int slot;
+        while ((slot = done_slots.pop()) >= 0)
+        {
+            pgm_write_frame(out_fp, slots[slot].dst);
+            std::chrono::duration<double, std::milli> latency = std::chrono::steady_clock::now() - slots[slot].arrival;
+            latency_ms.push_back(latency.count());
+            free_slots.push(slot);
+        }
+        free_slots.close();
+    });
+
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    int slot;
+    while ((slot = read_slots.pop()) >= 0)
+    {
+        process(slots[slot].src, slots[slot].dst);
+        done_slots.push(slot);
+    }
+    done_slots.close();
+
+    writer.join();
+    reader.join();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+
+    // latency report goes to stderr so stdout stays a clean frame stream
+    if (latency_ms.empty())
+    {
+        return;
+    }
+    std::sort(latency_ms.begin(), latency_ms.end());
+    size_t n = latency_ms.size();
+    fprintf(stderr, "frames %zu, %.1f fps, latency ms p50 %.3f p90 %.3f p99 %.3f max %.3f\n", n,
+            n / elapsed.count(), latency_ms[n * 50 / 100], latency_ms[n * 90 / 100], latency_ms[n * 99 / 100],
+            latency_ms[n - 1]);
+}
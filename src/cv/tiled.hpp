@@ -0,0 +1,322 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "lz.hpp"
+#include "pgm.hpp"
+#include "view.hpp"
+
+// file layout:
+//   tiled_header_t
+//   tiled_entry_t[tiles_x * tiles_y]  (row major)
+//   tile payloads, each either raw or lz compressed, tile rows packed without padding
+
+#define TILED_MAGIC        "TIM1"
+#define TILED_DEFAULT_SIZE 256U
+#define TILED_COMPRESSED   0x1U
+
+typedef struct
+{
+    char magic[4];
+    uint32_t width;
+    uint32_t height;
+    uint32_t tile_size;
+    uint32_t max_gray;
+    uint32_t flags;
+} tiled_header_t;
+
+typedef struct
+{
+    uint64_t offset;
+    uint32_t stored_size;
+    uint8_t compressed;
+    uint8_t min;
+    uint8_t max;
+    uint8_t reserved;
+    uint32_t hist[256];
+} tiled_entry_t;
+
+// 64-bit seek so containers larger than 2GB work on every platform
+static void tiled_seek(FILE *fp, uint64_t offset)
+{
+#ifdef _WIN32
+    _fseeki64(fp, (__int64)offset, SEEK_SET);
+#else
+    fseeko(fp, (off_t)offset, SEEK_SET);
+#endif
+}
+
+class tiled_t
+{
+public:
+    tiled_t(const std::string &filename)
+    {
+        this->_fp = fopen(filename.c_str(), "rb");
+        assert(this->_fp != NULL);
+
+        size_t read = fread(&this->_header, sizeof(this->_header), 1, this->_fp);
+        assert(read == 1);
+        assert(memcmp(this->_header.magic, TILED_MAGIC, 4) == 0);
+        assert(this->_header.tile_size > 0);
+
+        this->_index.resize(this->tiles_x() * this->tiles_y());
+        read = fread(this->_index.data(), sizeof(tiled_entry_t), this->_index.size(), this->_fp);
+        assert(read == this->_index.size());
+    }
+
+    ~tiled_t() { fclose(this->_fp); }
+
+    uint32_t width() { return this->_header.width; }
+    uint32_t height() { return this->_header.height; }
+    uint32_t max_gray() { return this->_header.max_gray; }
+    uint32_t tile_size() { return this->_header.tile_size; }
+    uint32_t tiles_x() { return (this->_header.width + this->_header.tile_size - 1) / this->_header.tile_size; }
+    uint32_t tiles_y() { return (this->_header.height + this->_header.tile_size - 1) / this->_header.tile_size; }
+    uint32_t tile_width(uint32_t tx) { return std::min(this->_header.tile_size, this->_header.width - tx * this->_header.tile_size); }
+    uint32_t tile_height(uint32_t ty) { return std::min(this->_header.tile_size, this->_header.height - ty * this->_header.tile_size); }
+
+    const tiled_entry_t &tile_info(uint32_t tx, uint32_t ty) { return this->_index[ty * this->tiles_x() + tx]; }
+
+    // decode one tile into dst, rows dst_stride bytes apart
+    void read_tile(uint32_t tx, uint32_t ty, uint8_t *dst, uint32_t dst_stride)
+    {
+        const tiled_entry_t &entry = this->tile_info(tx, ty);
+        uint32_t tile_w = this->tile_width(tx);
+        uint32_t tile_h = this->tile_height(ty);
+        uint32_t raw_size = tile_w * tile_h;
+
+        this->_stored.resize(entry.stored_size);
+        tiled_seek(this->_fp, entry.offset);
+        size_t read = fread(this->_stored.data(), entry.stored_size, 1, this->_fp);
+        assert(read == 1);
+
+        const uint8_t *raw = this->_stored.data();
+        if (entry.compressed)
+        {
+            this->_decoded.resize(raw_size);
+            uint32_t size = lz_decompress(this->_stored.data(), entry.stored_size, this->_decoded.data(), raw_size);
+            assert(size == raw_size);
+            raw = this->_decoded.data();
+        }
+
+        for (uint32_t y = 0; y < tile_h; y++)
+        {
+            memcpy(dst + y * dst_stride, raw + y * tile_w, tile_w);
+        }
+    }
+
+    // fetch only the tiles overlapping [x, x + dst.width()) x [y, y + dst.height())
+    void read_roi(uint32_t x, uint32_t y, image_view_t dst)
+    {
+        uint32_t roi_w = dst.width();
+        uint32_t roi_h = dst.height();
+        assert((x + roi_w <= this->width()) && (y + roi_h <= this->height()));
+        if ((roi_w == 0) || (roi_h == 0))
+        {
+            return;
+        }
+
+        uint32_t ts = this->tile_size();
+
+        this->_tile.resize(ts * ts);
+        for (uint32_t ty = y / ts; ty <= (y + roi_h - 1) / ts; ty++)
+        {
+            for (uint32_t tx = x / ts; tx <= (x + roi_w - 1) / ts; tx++)
+            {
+                uint32_t tile_x0 = tx * ts;
+                uint32_t tile_y0 = ty * ts;
+                uint32_t tile_w = this->tile_width(tx);
+                uint32_t tile_h = this->tile_height(ty);
+
+                // copy full tiles straight into place
+                if ((tile_x0 >= x) && (tile_y0 >= y) && (tile_x0 + tile_w <= x + roi_w) && (tile_y0 + tile_h <= y + roi_h))
+                {
+                    this->read_tile(tx, ty, dst.row(tile_y0 - y) + (tile_x0 - x), dst.stride());
+                    continue;
+                }
+
+                this->read_tile(tx, ty, this->_tile.data(), ts);
+
+                uint32_t x0 = std::max(x, tile_x0);
+                uint32_t x1 = std::min(x + roi_w, tile_x0 + tile_w);
+                uint32_t y0 = std::max(y, tile_y0);
+                uint32_t y1 = std::min(y + roi_h, tile_y0 + tile_h);
+                for (uint32_t row = y0; row < y1; row++)
+                {
+                    memcpy(dst.row(row - y) + (x0 - x), this->_tile.data() + (row - tile_y0) * ts + (x0 - tile_x0), x1 - x0);
+                }
+            }
+        }
+    }
+
+private:
+    FILE *_fp;
+    tiled_header_t _header;
+    std::vector<tiled_entry_t> _index;
+    std::vector<uint8_t> _stored;
+    std::vector<uint8_t> _decoded;
+    std::vector<uint8_t> _tile;
+};
+
+class tiled_writer_t
+{
+public:
+    tiled_writer_t(const std::string &filename, uint32_t width, uint32_t height, uint32_t tile_size, bool compress)
+    {
+        this->_fp = fopen(filename.c_str(), "wb");
+        assert(this->_fp != NULL);
+        assert(tile_size > 0);
+
+        memcpy(this->_header.magic, TILED_MAGIC, 4);
+        this->_header.width = width;
+        this->_header.height = height;
+        this->_header.tile_size = tile_size;
+        this->_header.max_gray = 255;
+        this->_header.flags = compress ? TILED_COMPRESSED : 0;
+
+        uint32_t tiles_x = (width + tile_size - 1) / tile_size;
+        uint32_t tiles_y = (height + tile_size - 1) / tile_size;
+        this->_index.resize(tiles_x * tiles_y);
+        memset(this->_index.data(), 0, this->_index.size() * sizeof(tiled_entry_t));
+
+        // index is rewritten on close once all offsets are known
+        fwrite(&this->_header, sizeof(this->_header), 1, this->_fp);
+        fwrite(this->_index.data(), sizeof(tiled_entry_t), this->_index.size(), this->_fp);
+        this->_offset = sizeof(this->_header) + this->_index.size() * sizeof(tiled_entry_t);
+    }
+
+    ~tiled_writer_t() { this->close(); }
+
+    uint32_t tile_size() { return this->_header.tile_size; }
+    uint32_t tiles_x() { return (this->_header.width + this->_header.tile_size - 1) / this->_header.tile_size; }
+    uint32_t tiles_y() { return (this->_header.height + this->_header.tile_size - 1) / this->_header.tile_size; }
+    uint32_t tile_width(uint32_t tx) { return std::min(this->_header.tile_size, this->_header.width - tx * this->_header.tile_size); }
+    uint32_t tile_height(uint32_t ty) { return std::min(this->_header.tile_size, this->_header.height - ty * this->_header.tile_size); }
+
+    // src points at the tile's top-left pixel, rows src_stride bytes apart
+    void write_tile(uint32_t tx, uint32_t ty, const uint8_t *src, uint32_t src_stride)
+    {
+        uint32_t tile_w = this->tile_width(tx);
+        uint32_t tile_h = this->tile_height(ty);
+        uint32_t raw_size = tile_w * tile_h;
+        tiled_entry_t &entry = this->_index[ty * this->tiles_x() + tx];
+
+        // pack rows and gather tile statistics
+        this->_raw.resize(raw_size);
+        memset(entry.hist, 0, sizeof(entry.hist));
+        for (uint32_t y = 0; y < tile_h; y++)
+        {
+            memcpy(this->_raw.data() + y * tile_w, src + y * src_stride, tile_w);
+        }
+        uint8_t min = 255, max = 0;
+        for (uint32_t i = 0; i < raw_size; i++)
+        {
+            uint8_t val = this->_raw[i];
+            min = (val < min) ? val : min;
+            max = (val > max) ? val : max;
+            entry.hist[val]++;
+        }
+        entry.min = min;
+        entry.max = max;
+
+        // keep the raw tile when compression does not pay off
+        const uint8_t *payload = this->_raw.data();
+        uint32_t payload_size = raw_size;
+        entry.compressed = 0;
+        if (this->_header.flags & TILED_COMPRESSED)
+        {
+            this->_packed.resize(raw_size);
+            uint32_t size = lz_compress(this->_raw.data(), raw_size, this->_packed.data(), raw_size - 1);
+            if (size > 0)
+            {
+                payload = this->_packed.data();
+                payload_size = size;
+                entry.compressed = 1;
+            }
+        }
+
+        entry.offset = this->_offset;
+        entry.stored_size = payload_size;
+        tiled_seek(this->_fp, this->_offset);
+        fwrite(payload, payload_size, 1, this->_fp);
+        this->_offset += payload_size;
+    }
+
+    void close()
+    {
+        if (this->_fp == NULL)
+        {
+            return;
+        }
+        tiled_seek(this->_fp, sizeof(this->_header));
+        fwrite(this->_index.data(), sizeof(tiled_entry_t), this->_index.size(), this->_fp);
+        fclose(this->_fp);
+        this->_fp = NULL;
+    }
+
+private:
+    FILE *_fp;
+    tiled_header_t _header;
+    std::vector<tiled_entry_t> _index;
+    std::vector<uint8_t> _raw;
+    std::vector<uint8_t> _packed;
+    uint64_t _offset;
+};
+
+void pgm_to_tiled(image_view_t src_img, const std::string &filename, uint32_t tile_size, bool compress)
+{
+    tiled_writer_t writer(filename, src_img.width(), src_img.height(), tile_size, compress);
+
+    for (uint32_t ty = 0; ty < writer.tiles_y(); ty++)
+    {
+        for (uint32_t tx = 0; tx < writer.tiles_x(); tx++)
+        {
+            writer.write_tile(tx, ty, src_img.row(ty * tile_size) + tx * tile_size, src_img.stride());
+        }
+    }
+}
+
+void tiled_to_pgm(tiled_t &src, image_view_t dst_img)
+{
+    assert((dst_img.width() == src.width()) && (dst_img.height() == src.height()));
+    src.read_roi(0, 0, dst_img);
+}
+
+// run op tile by tile; each tile is read with a halo of neighbouring pixels so that
+// neighbourhood operators (blur, edge) give the same result as on the whole image
+void process_tiled(tiled_t &src, tiled_writer_t &dst, uint32_t halo, std::function<void(image_view_t, image_view_t)> op)
+{
+    assert(dst.tile_size() == src.tile_size());
+    uint32_t ts = src.tile_size();
+
+    // one buffer pair sized for the largest haloed tile, every tile works on views into it
+    pgm_t in_buf(ts + 2 * halo, ts + 2 * halo);
+    pgm_t out_buf(ts + 2 * halo, ts + 2 * halo);
+
+    for (uint32_t ty = 0; ty < src.tiles_y(); ty++)
+    {
+        for (uint32_t tx = 0; tx < src.tiles_x(); tx++)
+        {
+            uint32_t tile_x0 = tx * ts;
+            uint32_t tile_y0 = ty * ts;
+            uint32_t x0 = (tile_x0 > halo) ? (tile_x0 - halo) : 0;
+            uint32_t y0 = (tile_y0 > halo) ? (tile_y0 - halo) : 0;
+            uint32_t x1 = std::min(src.width(), tile_x0 + src.tile_width(tx) + halo);
+            uint32_t y1 = std::min(src.height(), tile_y0 + src.tile_height(ty) + halo);
+
+            image_view_t in_img = image_view_t(in_buf).sub(0, 0, x1 - x0, y1 - y0);
+            image_view_t out_img = image_view_t(out_buf).sub(0, 0, x1 - x0, y1 - y0);
+            src.read_roi(x0, y0, in_img);
+            op(in_img, out_img);
+
+            dst.write_tile(tx, ty, out_img.row(tile_y0 - y0) + (tile_x0 - x0), out_img.stride());
+        }
+    }
+}
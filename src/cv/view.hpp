@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+
+#include "pgm.hpp"
+
+// non-owning window into 8-bit pixel memory, rows are stride bytes apart
+class image_view_t
+{
+public:
+    image_view_t(uint8_t *ptr, uint32_t width, uint32_t height, uint32_t stride)
+    {
+        assert(stride >= width);
+        this->_ptr = ptr;
+        this->_width = width;
+        this->_height = height;
+        this->_stride = stride;
+    }
+
+    image_view_t(pgm_t &img)
+    {
+        this->_ptr = img.ptr();
+        this->_width = img.width();
+        this->_height = img.height();
+        this->_stride = img.width();
+    }
+
+    // sub-rectangle sharing the same pixels
+    image_view_t sub(uint32_t x, uint32_t y, uint32_t width, uint32_t height)
+    {
+        assert((x + width <= this->_width) && (y + height <= this->_height));
+        return image_view_t(this->row(y) + x, width, height, this->_stride);
+    }
+
+    uint32_t height() { return this->_height; }
+    uint32_t width() { return this->_width; }
+    uint32_t stride() { return this->_stride; }
+    uint8_t *ptr() { return this->_ptr; }
+    uint8_t *row(uint32_t y) { return this->_ptr + (size_t)y * this->_stride; }
+
+private:
+    uint8_t *_ptr;
+    uint32_t _width;
+    uint32_t _height;
+    uint32_t _stride;
+};
@@ -0,0 +1,190 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "border.hpp"
+#include "dispatch.hpp"
+#include "enums.hpp"
+#include "parallel.hpp"
+#include "view.hpp"
+
+// dst pixels per tile side, keeps the source lines a tile touches in cache when rotating
+#define WARP_TILE 64
+
+// x' = m[0] * x + m[1] * y + m[2], y' = m[3] * x + m[4] * y + m[5], pixel centres on integers
+typedef struct
+{
+    double m[6];
+} affine_t;
+
+// rotation by angle degrees (counter-clockwise as displayed, y pointing down) and scale about (cx, cy)
+affine_t affine_rotation(double cx, double cy, double angle, double scale)
+{
+    double radians = angle * acos(-1.0) / 180;
+    double a = scale * cos(radians);
+    double b = scale * sin(radians);
+    affine_t rotation = {{a, b, (1 - a) * cx - b * cy, -b, a, b * cx + (1 - a) * cy}};
+    return rotation;
+}
+
+affine_t affine_invert(const affine_t &transform)
+{
+    const double *m = transform.m;
+    double det = m[0] * m[4] - m[1] * m[3];
+    assert(det != 0);
+
+    affine_t inverse = {{m[4] / det, -m[1] / det, (m[1] * m[5] - m[4] * m[2]) / det, -m[3] / det, m[0] / det,
+                         (m[3] * m[2] - m[0] * m[5]) / det}};
+    return inverse;
+}
+
+// coordinate to fixed point, clamped so sums of two terms stay inside int32; anything that
+// far out is outside every image this handles
+int32_t warp_fixed(double v)
+{
+    const double max_fixed = (double)(1 << 29);
+    double fixed = v * (1 << WARP_FRAC_BITS);
+    fixed = std::max(-max_fixed, std::min(max_fixed, fixed));
+    return (int32_t)lround(fixed);
+}
+
+// the sample and, for bilinear, its right and lower neighbours are all inside
+bool warp_inside(int32_t x_fixed, int32_t y_fixed, uint32_t width, uint32_t height, bool bilinear)
+{
+    int32_t round = bilinear ? 0 : (1 << (WARP_FRAC_BITS - 1));
+    int32_t margin = bilinear ? 1 : 0;
+    int32_t ix = (x_fixed + round) >> WARP_FRAC_BITS;
+    int32_t iy = (y_fixed + round) >> WARP_FRAC_BITS;
+    return (ix >= 0) && (iy >= 0) && (ix + margin < (int32_t)width) && (iy + margin < (int32_t)height);
+}
+
+uint8_t warp_border_pixel(image_view_t src_img, int32_t x, int32_t y, edge_e edge)
+{
+    int pos_x = border_index(x, src_img.width(), edge);
+    int pos_y = border_index(y, src_img.height(), edge);
+    return ((pos_x < 0) || (pos_y < 0)) ? 0 : src_img.row(pos_y)[pos_x];
+}
+
+// same arithmetic as the warp_row kernels, every neighbour mapped through the edge mode
+uint8_t warp_border_sample(image_view_t src_img, int32_t x_fixed, int32_t y_fixed, bool bilinear, edge_e edge)
+{
+    if (!bilinear)
+    {
+        int32_t half = 1 << (WARP_FRAC_BITS - 1);
+        return warp_border_pixel(src_img, (x_fixed + half) >> WARP_FRAC_BITS, (y_fixed + half) >> WARP_FRAC_BITS, edge);
+    }
+
+    int32_t ix = x_fixed >> WARP_FRAC_BITS;
+    int32_t iy = y_fixed >> WARP_FRAC_BITS;
+    int32_t fx = (x_fixed >> (WARP_FRAC_BITS - 8)) & 0xFF;
+    int32_t fy = (y_fixed >> (WARP_FRAC_BITS - 8)) & 0xFF;
+    int32_t p00 = warp_border_pixel(src_img, ix, iy, edge);
+    int32_t p01 = warp_border_pixel(src_img, ix + 1, iy, edge);
+    int32_t p10 = warp_border_pixel(src_img, ix, iy + 1, edge);
+    int32_t p11 = warp_border_pixel(src_img, ix + 1, iy + 1, edge);
+    int32_t top = (p00 << 8) + (p01 - p00) * fx;
+    int32_t bottom = (p10 << 8) + (p11 - p10) * fx;
+    return (uint8_t)(((top << 8) + (bottom - top) * fy + (1 << 15)) >> 16);
+}
+
+// dst = src warped by transform (src -> dst coordinates), method nearest_neighbor or bilinear.
+// source coordinates are per column and per row fixed-point terms, so each pixel costs one
+// integer add; the inside of every row is one run handed to the dispatched warp_row kernel
+void warp_affine(image_view_t src_img, image_view_t dst_img, const affine_t &transform, resize_e method, edge_e edge)
+{
+    uint32_t width = dst_img.width();
+    uint32_t height = dst_img.height();
+    uint32_t src_width = src_img.width();
+    uint32_t src_height = src_img.height();
+    uint32_t src_stride = src_img.stride();
+    assert((src_width > 0) && (src_height > 0) && (src_width < (1u << 18)) && (src_height < (1u << 18)));
+    assert((uint64_t)src_stride * src_height < (1u << 31));
+    uint32_t src_size = src_stride * (src_height - 1) + src_width;
+    bool interpolate = (method == bilinear);
+
+    affine_t inverse = affine_invert(transform);
+    const double *m = inverse.m;
+    std::vector<int32_t> map_x(width);
+    std::vector<int32_t> map_y(width);
+    for (uint32_t x = 0; x < width; x++)
+    {
+        map_x[x] = warp_fixed(m[0] * x);
+        map_y[x] = warp_fixed(m[3] * x);
+    }
+
+    const simd_kernels_t &kernels = simd_kernels();
+    parallel_rows(height, [&](uint32_t y0, uint32_t y1) {
+        // inside run [begin, end) of every row; the mapping is affine and the rounding monotonic,
+        // so the samples inside the image are always one contiguous run
+        std::vector<uint32_t> begin(y1 - y0);
+        std::vector<uint32_t> end(y1 - y0);
+        std::vector<int32_t> base_x(y1 - y0);
+        std::vector<int32_t> base_y(y1 - y0);
+        for (uint32_t y = y0; y < y1; y++)
+        {
+            uint32_t i = y - y0;
+            base_x[i] = warp_fixed(m[1] * y + m[2]);
+            base_y[i] = warp_fixed(m[4] * y + m[5]);
+
+            uint32_t b = 0;
+            while ((b < width) && !warp_inside(map_x[b] + base_x[i], map_y[b] + base_y[i], src_width, src_height,
+                                               interpolate))
+            {
+                b++;
+            }
+            uint32_t e = width;
+            while ((e > b) && !warp_inside(map_x[e - 1] + base_x[i], map_y[e - 1] + base_y[i], src_width, src_height,
+                                           interpolate))
+            {
+                e--;
+            }
+            begin[i] = b;
+            end[i] = e;
+        }
+
+        for (uint32_t ty = y0; ty < y1; ty += WARP_TILE)
+        {
+            uint32_t ty1 = std::min(ty + WARP_TILE, y1);
+            for (uint32_t tx = 0; tx < width; tx += WARP_TILE)
+            {
+                uint32_t tx1 = std::min(tx + WARP_TILE, width);
+                for (uint32_t y = ty; y < ty1; y++)
+                {
+                    uint32_t i = y - y0;
+                    uint8_t *dst_ptr = dst_img.row(y);
+                    uint32_t b = std::min(std::max(begin[i], tx), tx1);
+                    uint32_t e = std::max(std::min(end[i], tx1), b);
+                    for (uint32_t x = tx; x < b; x++)
+                    {
+                        dst_ptr[x] = warp_border_sample(src_img, map_x[x] + base_x[i], map_y[x] + base_y[i], interpolate,
+                                                        edge);
+                    }
+                    kernels.warp_row(src_img.ptr(), src_stride, src_size, map_x.data() + b, map_y.data() + b, base_x[i],
+                                     base_y[i], dst_ptr + b, e - b, interpolate);
+                    for (uint32_t x = e; x < tx1; x++)
+                    {
+                        dst_ptr[x] = warp_border_sample(src_img, map_x[x] + base_x[i], map_y[x] + base_y[i], interpolate,
+                                                        edge);
+                    }
+                }
+            }
+        }
+    });
+}
+
+// rotate about the image centre, dst keeps the src size and corners come from the edge mode
+void rotate(image_view_t src_img, image_view_t dst_img, double angle, resize_e method, edge_e edge)
+{
+    double cx = (src_img.width() - 1) / 2.0;
+    double cy = (src_img.height() - 1) / 2.0;
+    affine_t rotation = affine_rotation(cx, cy, angle, 1.0);
+
+    // keep the centre of src on the centre of dst when the sizes differ
+    rotation.m[2] += (dst_img.width() - 1) / 2.0 - cx;
+    rotation.m[5] += (dst_img.height() - 1) / 2.0 - cy;
+    warp_affine(src_img, dst_img, rotation, method, edge);
+}
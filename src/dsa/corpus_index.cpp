@@ -0,0 +1,430 @@
+// ************************************************
+// PRAGMAS
+// ************************************************
+#pragma once
+
+// ************************************************
+// INCLUDES
+// ************************************************
+#include "corpus_index.h"
+#include "work_stealing.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+// ************************************************
+// MACROS
+// ************************************************
+#define CORPUS_MIN_DOCS    64
+#define CORPUS_MIN_ENTRIES 1024
+#define QUERY_GRAIN        4
+#define PAIRS_GRAIN        16
+
+// ************************************************
+// TYPEDEF & ENUMS
+// ************************************************
+// per thread score accumulator over all documents, only touched entries are reset
+typedef struct
+{
+    uint64_t *dots;
+    uint32_t *touched;
+    size_t num_touched;
+} accumulator_t;
+
+typedef struct
+{
+    const corpus_index_t *index;
+    const sparse_vector_t *queries;
+    size_t k;
+    scored_doc_t *results;
+    size_t *num_results;
+    accumulator_t *accumulators;
+} batch_context_t;
+
+typedef struct
+{
+    const corpus_index_t *index;
+    double threshold;
+    accumulator_t *accumulators;
+    std::vector<doc_pair_t> *pairs;
+} pairs_context_t;
+
+// ************************************************
+// FUNCTION DECLARATIONS
+// ************************************************
+static void initAccumulator(accumulator_t *accumulator, size_t num_docs);
+static void freeAccumulator(accumulator_t *accumulator);
+static void accumulateQuery(const corpus_index_t *index, const uint32_t *terms, const uint32_t *counts, size_t size,
+                            uint32_t min_doc, accumulator_t *accumulator);
+static double queryNorm(const uint32_t *counts, size_t size);
+static size_t collectTopK(const corpus_index_t *index, double query_norm, size_t k, accumulator_t *accumulator,
+                          scored_doc_t *results);
+static bool isWorse(const scored_doc_t *lhs, const scored_doc_t *rhs);
+static void siftDown(scored_doc_t *heap, size_t size, size_t pos);
+static int compareScores(const void *lhs, const void *rhs);
+static int comparePairs(const void *lhs, const void *rhs);
+static void batchRange(size_t begin, size_t end, unsigned worker, void *context);
+static void pairsRange(size_t begin, size_t end, unsigned worker, void *context);
+
+// ************************************************
+// FUNCTION DEFINITIONS
+// ************************************************
+void initCorpusIndex(corpus_index_t *index)
+{
+    memset(index, 0, sizeof(*index));
+    index->max_docs       = CORPUS_MIN_DOCS;
+    index->max_entries    = CORPUS_MIN_ENTRIES;
+    index->doc_offsets    = (size_t *)malloc((index->max_docs + 1) * sizeof(size_t));
+    index->doc_terms      = (uint32_t *)malloc(index->max_entries * sizeof(uint32_t));
+    index->doc_counts     = (uint32_t *)malloc(index->max_entries * sizeof(uint32_t));
+    if (!index->doc_offsets || !index->doc_terms || !index->doc_counts)
+        assert(0);
+    index->doc_offsets[0] = 0;
+}
+
+void freeCorpusIndex(corpus_index_t *index)
+{
+    free(index->doc_offsets);
+    free(index->doc_terms);
+    free(index->doc_counts);
+    free(index->term_offsets);
+    free(index->postings);
+    free(index->norms);
+    memset(index, 0, sizeof(*index));
+}
+
+uint32_t addCorpusDocument(corpus_index_t *index, const sparse_vector_t *vector)
+{
+    assert(index->postings == NULL);    // no additions after finalize
+
+    if (index->num_docs == index->max_docs)
+    {
+        index->max_docs *= 2;
+        index->doc_offsets = (size_t *)realloc(index->doc_offsets, (index->max_docs + 1) * sizeof(size_t));
+        if (!index->doc_offsets)
+            assert(0);
+    }
+    while (index->num_entries + vector->size > index->max_entries)
+    {
+        index->max_entries *= 2;
+        index->doc_terms  = (uint32_t *)realloc(index->doc_terms, index->max_entries * sizeof(uint32_t));
+        index->doc_counts = (uint32_t *)realloc(index->doc_counts, index->max_entries * sizeof(uint32_t));
+        if (!index->doc_terms || !index->doc_counts)
+            assert(0);
+    }
+
+    memcpy(&index->doc_terms[index->num_entries], vector->ids, vector->size * sizeof(uint32_t));
+    memcpy(&index->doc_counts[index->num_entries], vector->counts, vector->size * sizeof(uint32_t));
+    index->num_entries += vector->size;
+    if (vector->size && vector->ids[vector->size - 1] >= index->num_terms)
+    {
+        index->num_terms = vector->ids[vector->size - 1] + 1;
+    }
+
+    uint32_t doc                = (uint32_t)index->num_docs++;
+    index->doc_offsets[doc + 1] = index->num_entries;
+
+    return doc;
+}
+
+void finalizeCorpusIndex(corpus_index_t *index)
+{
+    // counting sort of (term, doc) entries by term, docs were added in order so postings stay sorted by doc
+    index->term_offsets = (size_t *)calloc(index->num_terms + 1, sizeof(size_t));
+    index->postings     = (posting_t *)malloc((index->num_entries + 1) * sizeof(posting_t));
+    index->norms        = (double *)malloc((index->num_docs + 1) * sizeof(double));
+    if (!index->term_offsets || !index->postings || !index->norms)
+        assert(0);
+
+    for (size_t i = 0; i < index->num_entries; i++)
+    {
+        index->term_offsets[index->doc_terms[i] + 1]++;
+    }
+    for (size_t t = 0; t < index->num_terms; t++)
+    {
+        index->term_offsets[t + 1] += index->term_offsets[t];
+    }
+
+    size_t *fill = (size_t *)malloc((index->num_terms + 1) * sizeof(size_t));
+    if (!fill)
+        assert(0);
+    memcpy(fill, index->term_offsets, (index->num_terms + 1) * sizeof(size_t));
+
+    for (size_t doc = 0; doc < index->num_docs; doc++)
+    {
+        size_t begin = index->doc_offsets[doc];
+        size_t end   = index->doc_offsets[doc + 1];
+        for (size_t i = begin; i < end; i++)
+        {
+            posting_t *posting = &index->postings[fill[index->doc_terms[i]]++];
+            posting->doc       = (uint32_t)doc;
+            posting->count     = index->doc_counts[i];
+        }
+        index->norms[doc] = queryNorm(&index->doc_counts[begin], end - begin);
+    }
+
+    free(fill);
+}
+
+size_t queryTopK(const corpus_index_t *index, const sparse_vector_t *query, size_t k, scored_doc_t *results)
+{
+    accumulator_t accumulator;
+    initAccumulator(&accumulator, index->num_docs);
+
+    accumulateQuery(index, query->ids, query->counts, query->size, 0, &accumulator);
+    size_t found = collectTopK(index, queryNorm(query->counts, query->size), k, &accumulator, results);
+
+    freeAccumulator(&accumulator);
+
+    return found;
+}
+
+void queryTopKBatch(const corpus_index_t *index, const sparse_vector_t *queries, size_t num_queries, size_t k,
+                    scored_doc_t *results, size_t *num_results, unsigned num_threads)
+{
+    // results of query q go to results[q * k], its count to num_results[q]
+    num_threads = resolveThreadCount(num_threads);
+    std::vector<accumulator_t> accumulators(num_threads);
+    for (unsigned i = 0; i < num_threads; i++)
+    {
+        initAccumulator(&accumulators[i], index->num_docs);
+    }
+
+    batch_context_t context = {index, queries, k, results, num_results, accumulators.data()};
+    parallelFor(num_queries, QUERY_GRAIN, batchRange, &context, num_threads);
+
+    for (unsigned i = 0; i < num_threads; i++)
+    {
+        freeAccumulator(&accumulators[i]);
+    }
+}
+
+size_t findSimilarPairs(const corpus_index_t *index, double threshold, doc_pair_t **pairs, unsigned num_threads)
+{
+    // every doc is a query against the docs after it; costs are skewed, hence work stealing
+    num_threads = resolveThreadCount(num_threads);
+    std::vector<accumulator_t> accumulators(num_threads);
+    std::vector<std::vector<doc_pair_t> > worker_pairs(num_threads);
+    for (unsigned i = 0; i < num_threads; i++)
+    {
+        initAccumulator(&accumulators[i], index->num_docs);
+    }
+
+    pairs_context_t context = {index, threshold, accumulators.data(), worker_pairs.data()};
+    parallelFor(index->num_docs, PAIRS_GRAIN, pairsRange, &context, num_threads);
+
+    size_t num_pairs = 0;
+    for (unsigned i = 0; i < num_threads; i++)
+    {
+        num_pairs += worker_pairs[i].size();
+        freeAccumulator(&accumulators[i]);
+    }
+
+    *pairs = (doc_pair_t *)malloc((num_pairs + 1) * sizeof(doc_pair_t));
+    if (!*pairs)
+        assert(0);
+
+    size_t pos = 0;
+    for (unsigned i = 0; i < num_threads; i++)
+    {
+        if (!worker_pairs[i].empty())
+            memcpy(&(*pairs)[pos], worker_pairs[i].data(), worker_pairs[i].size() * sizeof(doc_pair_t));
+        pos += worker_pairs[i].size();
+    }
+    qsort(*pairs, num_pairs, sizeof(doc_pair_t), comparePairs);
+
+    return num_pairs;
+}
+
+void initAccumulator(accumulator_t *accumulator, size_t num_docs)
+{
+    accumulator->dots        = (uint64_t *)calloc(num_docs + 1, sizeof(uint64_t));
+    accumulator->touched     = (uint32_t *)malloc((num_docs + 1) * sizeof(uint32_t));
+    accumulator->num_touched = 0;
+    if (!accumulator->dots || !accumulator->touched)
+        assert(0);
+}
+
+void freeAccumulator(accumulator_t *accumulator)
+{
+    free(accumulator->dots);
+    free(accumulator->touched);
+}
+
+void accumulateQuery(const corpus_index_t *index, const uint32_t *terms, const uint32_t *counts, size_t size,
+                     uint32_t min_doc, accumulator_t *accumulator)
+{
+    for (size_t i = 0; i < size; i++)
+    {
+        if (terms[i] >= index->num_terms)
+            continue;
+
+        const posting_t *posting = &index->postings[index->term_offsets[terms[i]]];
+        const posting_t *end     = &index->postings[index->term_offsets[terms[i] + 1]];
+
+        // postings are sorted by doc, skip the ones below min_doc
+        if (min_doc)
+        {
+            size_t lo = 0, hi = end - posting;
+            while (lo < hi)
+            {
+                size_t mid = (lo + hi) / 2;
+                if (posting[mid].doc < min_doc)
+                    lo = mid + 1;
+                else
+                    hi = mid;
+            }
+            posting += lo;
+        }
+
+        for (; posting < end; posting++)
+        {
+            if (accumulator->dots[posting->doc] == 0)
+            {
+                accumulator->touched[accumulator->num_touched++] = posting->doc;
+            }
+            accumulator->dots[posting->doc] += (uint64_t)counts[i] * posting->count;
+        }
+    }
+}
+
+double queryNorm(const uint32_t *counts, size_t size)
+{
+    uint64_t sum = 0;
+    for (size_t i = 0; i < size; i++)
+    {
+        sum += (uint64_t)counts[i] * counts[i];
+    }
+
+    return sqrt((double)sum);
+}
+
+size_t collectTopK(const corpus_index_t *index, double query_norm, size_t k, accumulator_t *accumulator,
+                   scored_doc_t *results)
+{
+    // min heap of the k best, the root is the current worst
+    size_t size = 0;
+    for (size_t i = 0; i < accumulator->num_touched; i++)
+    {
+        uint32_t doc           = accumulator->touched[i];
+        scored_doc_t scored    = {doc, accumulator->dots[doc] / (query_norm * index->norms[doc])};
+        accumulator->dots[doc] = 0;
+
+        if (size < k)
+        {
+            // sift up
+            size_t pos = size++;
+            while (pos > 0 && isWorse(&scored, &results[(pos - 1) / 2]))
+            {
+                results[pos] = results[(pos - 1) / 2];
+                pos          = (pos - 1) / 2;
+            }
+            results[pos] = scored;
+        }
+        else if (k && isWorse(&results[0], &scored))
+        {
+            results[0] = scored;
+            siftDown(results, size, 0);
+        }
+    }
+    accumulator->num_touched = 0;
+
+    qsort(results, size, sizeof(scored_doc_t), compareScores);
+
+    return size;
+}
+
+bool isWorse(const scored_doc_t *lhs, const scored_doc_t *rhs)
+{
+    // lower score loses, ties go to the lower doc id
+    if (lhs->score != rhs->score)
+        return lhs->score < rhs->score;
+
+    return lhs->doc > rhs->doc;
+}
+
+void siftDown(scored_doc_t *heap, size_t size, size_t pos)
+{
+    while (1)
+    {
+        size_t worst = pos;
+        size_t left  = 2 * pos + 1;
+        size_t right = 2 * pos + 2;
+        if (left < size && isWorse(&heap[left], &heap[worst]))
+            worst = left;
+        if (right < size && isWorse(&heap[right], &heap[worst]))
+            worst = right;
+        if (worst == pos)
+            return;
+
+        scored_doc_t temp = heap[pos];
+        heap[pos]         = heap[worst];
+        heap[worst]       = temp;
+        pos               = worst;
+    }
+}
+
+int compareScores(const void *lhs, const void *rhs)
+{
+    // best first
+    const scored_doc_t *doc1 = (const scored_doc_t *)lhs;
+    const scored_doc_t *doc2 = (const scored_doc_t *)rhs;
+
+    return isWorse(doc1, doc2) ? 1 : (isWorse(doc2, doc1) ? -1 : 0);
+}
+
+int comparePairs(const void *lhs, const void *rhs)
+{
+    const doc_pair_t *pair1 = (const doc_pair_t *)lhs;
+    const doc_pair_t *pair2 = (const doc_pair_t *)rhs;
+    if (pair1->doc1 != pair2->doc1)
+        return (pair1->doc1 < pair2->doc1) ? -1 : 1;
+    if (pair1->doc2 != pair2->doc2)
+        return (pair1->doc2 < pair2->doc2) ? -1 : 1;
+
+    return 0;
+}
+
+void batchRange(size_t begin, size_t end, unsigned worker, void *context)
+{
+    batch_context_t *batch     = (batch_context_t *)context;
+    accumulator_t *accumulator = &batch->accumulators[worker];
+
+    for (size_t q = begin; q < end; q++)
+    {
+        const sparse_vector_t *query = &batch->queries[q];
+        accumulateQuery(batch->index, query->ids, query->counts, query->size, 0, accumulator);
+        batch->num_results[q] = collectTopK(batch->index, queryNorm(query->counts, query->size), batch->k, accumulator,
+                                            &batch->results[q * batch->k]);
+    }
+}
+
+void pairsRange(size_t begin, size_t end, unsigned worker, void *context)
+{
+    pairs_context_t *all        = (pairs_context_t *)context;
+    const corpus_index_t *index = all->index;
+    accumulator_t *accumulator  = &all->accumulators[worker];
+
+    for (size_t doc = begin; doc < end; doc++)
+    {
+        size_t first = index->doc_offsets[doc];
+        size_t size  = index->doc_offsets[doc + 1] - first;
+        accumulateQuery(index, &index->doc_terms[first], &index->doc_counts[first], size, (uint32_t)doc + 1, accumulator);
+
+        for (size_t i = 0; i < accumulator->num_touched; i++)
+        {
+            uint32_t other           = accumulator->touched[i];
+            double score             = accumulator->dots[other] / (index->norms[doc] * index->norms[other]);
+            accumulator->dots[other] = 0;
+
+            if (score >= all->threshold)
+            {
+                doc_pair_t pair = {(uint32_t)doc, other, score};
+                all->pairs[worker].push_back(pair);
+            }
+        }
+        accumulator->num_touched = 0;
+    }
+}
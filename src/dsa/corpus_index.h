@@ -0,0 +1,67 @@
+// ************************************************
+// PRAGMAS
+// ************************************************
+#pragma once
+
+// ************************************************
+// INCLUDES
+// ************************************************
+#include <stddef.h>
+#include <stdint.h>
+
+#include "document_distance.h"
+
+// ************************************************
+// MACROS
+// ************************************************
+
+// ************************************************
+// TYPEDEF & ENUMS
+// ************************************************
+typedef struct
+{
+    uint32_t doc;
+    uint32_t count;
+} posting_t;
+
+// forward (doc -> terms) and inverted (term -> docs) lists, both in CSR layout
+typedef struct
+{
+    size_t num_docs;
+    size_t num_terms;        // highest word id + 1
+    size_t num_entries;
+    size_t max_docs;
+    size_t max_entries;
+    size_t *doc_offsets;     // terms of doc d are [doc_offsets[d], doc_offsets[d + 1])
+    uint32_t *doc_terms;
+    uint32_t *doc_counts;
+    size_t *term_offsets;    // postings of term t are [term_offsets[t], term_offsets[t + 1])
+    posting_t *postings;
+    double *norms;
+} corpus_index_t;
+
+typedef struct
+{
+    uint32_t doc;
+    double score;
+} scored_doc_t;
+
+typedef struct
+{
+    uint32_t doc1;
+    uint32_t doc2;
+    double score;
+} doc_pair_t;
+
+// ************************************************
+// FUNCTION DECLARATIONS
+// ************************************************
+void initCorpusIndex(corpus_index_t *index);
+void freeCorpusIndex(corpus_index_t *index);
+uint32_t addCorpusDocument(corpus_index_t *index, const sparse_vector_t *vector);
+void finalizeCorpusIndex(corpus_index_t *index);
+
+size_t queryTopK(const corpus_index_t *index, const sparse_vector_t *query, size_t k, scored_doc_t *results);
+void queryTopKBatch(const corpus_index_t *index, const sparse_vector_t *queries, size_t num_queries, size_t k,
+                    scored_doc_t *results, size_t *num_results, unsigned num_threads);
+size_t findSimilarPairs(const corpus_index_t *index, double threshold, doc_pair_t **pairs, unsigned num_threads);
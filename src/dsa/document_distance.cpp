@@ -8,6 +8,7 @@
 // ************************************************
 #include "document_distance.h"
 #include <assert.h>
+#include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -15,14 +16,31 @@
 // ************************************************
 // MACROS
 // ************************************************
+#define VOCABULARY_MIN_WORDS  64
+#define HASH_MULTIPLIER       0x9E3779B97F4A7C15ULL
+#define COUNT_TABLE_MIN_SLOTS 16
 
 // ************************************************
 // TYPEDEF & ENUMS
 // ************************************************
+// word id -> count for one document, keys hold id + 1 so 0 marks an empty slot
+typedef struct
+{
+    uint32_t *keys;
+    uint32_t *counts;
+    size_t num_slots;    // power of two
+    size_t size;
+} count_table_t;
 
 // ************************************************
 // FUNCTION DECLARATIONS
 // ************************************************
+static void growVocabulary(vocabulary_t *vocabulary);
+static int compareIds(const void *id1, const void *id2);
+static void initCountTable(count_table_t *table, size_t num_slots);
+static void freeCountTable(count_table_t *table);
+static size_t findCountSlot(const count_table_t *table, uint32_t id);
+static void addCount(count_table_t *table, uint32_t id);
 
 // ************************************************
 // FUNCTION DEFINITIONS
@@ -30,68 +48,495 @@
 
 void splitDocument(document *document)
 {
-    // take a local copy of string
-    char *string = (char *)calloc(strlen(document->line) + 1, sizeof(char));
-    if (!string)
+    // tokenize the line in place, words longer than a slot are truncated
+    tokenizer_t tokenizer;
+    initTokenizer(&tokenizer, document->line, strlen(document->line), " ,.-", false);
+
+    token_t token;
+    while ((document->num_words < document->max_num_words) && nextToken(&tokenizer, &token))
+    {
+        size_t length = token.length;
+        if (length >= document->max_word_size)
+        {
+            length = document->max_word_size - 1;
+        }
+
+        char *word = &document->words[document->num_words * document->max_word_size];
+        memcpy(word, token.ptr, length);
+        word[length] = 0;
+        document->num_words++;
+    }
+}
+
+void countWordFrequencies(document *document)
+{
+    // first occurrence of each word holds its total count, repeats are zeroed & blanked
+    vocabulary_t vocabulary;
+    initVocabulary(&vocabulary, document->num_words);
+
+    size_t *first_pos = (size_t *)malloc((document->num_words + 1) * sizeof(size_t));
+    if (!first_pos)
+        assert(0);
+
+    for (size_t curr = 0; curr < document->num_words; curr++)
+    {
+        char *word  = &document->words[curr * document->max_word_size];
+        size_t size = vocabulary.num_words;
+        uint32_t id = internWord(&vocabulary, word, strlen(word));
+
+        if (id == size)    // new word
+        {
+            first_pos[id]             = curr;
+            document->frequency[curr] = 1;
+        }
+        else
+        {
+            document->frequency[first_pos[id]]++;
+            document->frequency[curr] = 0;
+            word[0]                   = 0;
+        }
+    }
+
+    free(first_pos);
+    freeVocabulary(&vocabulary);
+}
+
+uint32_t computeDotProduct(document *document1, document *document2)
+{
+    uint32_t dot_product = 0;
+
+    // index counted words of document2, blanked repeats have zero frequency
+    vocabulary_t vocabulary;
+    initVocabulary(&vocabulary, document2->num_words);
+
+    uint32_t *frequency = (uint32_t *)malloc((document2->num_words + 1) * sizeof(uint32_t));
+    if (!frequency)
         assert(0);
 
-    strcpy(string, document->line);
+    for (size_t ref = 0; ref < document2->num_words; ref++)
+    {
+        if (document2->frequency[ref] == 0)
+            continue;
+
+        char *word  = &document2->words[ref * document2->max_word_size];
+        uint32_t id   = internWord(&vocabulary, word, strlen(word));
+        frequency[id] = document2->frequency[ref];
+    }
 
-    // parse out words from line
-    size_t pos = 0;
-    char *word = strtok(string, " ,.-");
-    while (word != NULL && (pos < document->max_word_size * document->max_num_words))
+    for (size_t curr = 0; curr < document1->num_words; curr++)
     {
-        strcpy(&document->words[pos], word);
-        pos += document->max_word_size;
-        document->num_words++;
+        if (document1->frequency[curr] == 0)
+            continue;
 
-        word = strtok(NULL, " ,.-");
+        char *word = &document1->words[curr * document1->max_word_size];
+        int64_t id = findWord(&vocabulary, word, strlen(word));
+        if (id != WORD_NOT_FOUND)
+        {
+            dot_product += document1->frequency[curr] * frequency[id];
+        }
     }
 
-    // free local buffer
-    free(string);
+    free(frequency);
+    freeVocabulary(&vocabulary);
+
+    return dot_product;
 }
 
-void countWordFrequencies(document *document)
+uint64_t hashWord(const char *word, size_t length)
+{
+    // 8 bytes per multiply, then fold in the tail
+    uint64_t hash = length * HASH_MULTIPLIER;
+    size_t pos    = 0;
+    for (; pos + 8 <= length; pos += 8)
+    {
+        uint64_t chunk;
+        memcpy(&chunk, word + pos, sizeof(chunk));
+        hash = (hash ^ chunk) * HASH_MULTIPLIER;
+        hash ^= hash >> 29;
+    }
+
+    uint64_t tail = 0;
+    memcpy(&tail, word + pos, length - pos);
+    hash = (hash ^ tail) * HASH_MULTIPLIER;
+    hash ^= hash >> 32;
+
+    return hash;
+}
+
+void initVocabulary(vocabulary_t *vocabulary, size_t expected_words)
 {
-    // initialize frequency
+    size_t max_words = VOCABULARY_MIN_WORDS;
+    while (max_words < expected_words)
+    {
+        max_words *= 2;
+    }
+
+    vocabulary->num_words        = 0;
+    vocabulary->max_words        = max_words;
+    vocabulary->num_slots        = max_words * 2;    // load factor stays <= 0.5
+    vocabulary->slots            = (uint32_t *)calloc(vocabulary->num_slots, sizeof(uint32_t));
+    vocabulary->hashes           = (uint64_t *)malloc(max_words * sizeof(uint64_t));
+    vocabulary->offsets          = (size_t *)malloc(max_words * sizeof(size_t));
+    vocabulary->lengths          = (uint32_t *)malloc(max_words * sizeof(uint32_t));
+    vocabulary->strings_size     = 0;
+    vocabulary->strings_capacity = max_words * 8;
+    vocabulary->strings          = (char *)malloc(vocabulary->strings_capacity);
+    if (!vocabulary->slots || !vocabulary->hashes || !vocabulary->offsets || !vocabulary->lengths || !vocabulary->strings)
+        assert(0);
+}
+
+void freeVocabulary(vocabulary_t *vocabulary)
+{
+    free(vocabulary->slots);
+    free(vocabulary->hashes);
+    free(vocabulary->offsets);
+    free(vocabulary->lengths);
+    free(vocabulary->strings);
+    memset(vocabulary, 0, sizeof(*vocabulary));
+}
+
+int64_t findWord(const vocabulary_t *vocabulary, const char *word, size_t length)
+{
+    uint64_t hash = hashWord(word, length);
+    size_t mask   = vocabulary->num_slots - 1;
+
+    for (size_t slot = hash & mask;; slot = (slot + 1) & mask)
+    {
+        uint32_t entry = vocabulary->slots[slot];
+        if (entry == 0)
+        {
+            return WORD_NOT_FOUND;
+        }
+
+        uint32_t id = entry - 1;
+        if ((vocabulary->hashes[id] == hash) && (vocabulary->lengths[id] == length) &&
+            !memcmp(&vocabulary->strings[vocabulary->offsets[id]], word, length))
+        {
+            return id;
+        }
+    }
+}
+
+uint32_t internWord(vocabulary_t *vocabulary, const char *word, size_t length)
+{
+    int64_t found = findWord(vocabulary, word, length);
+    if (found != WORD_NOT_FOUND)
+    {
+        return (uint32_t)found;
+    }
+
+    if (vocabulary->num_words == vocabulary->max_words)
+    {
+        growVocabulary(vocabulary);
+    }
+
+    while (vocabulary->strings_size + length + 1 > vocabulary->strings_capacity)
+    {
+        vocabulary->strings_capacity *= 2;
+        vocabulary->strings = (char *)realloc(vocabulary->strings, vocabulary->strings_capacity);
+        if (!vocabulary->strings)
+            assert(0);
+    }
+
+    uint32_t id             = (uint32_t)vocabulary->num_words++;
+    uint64_t hash           = hashWord(word, length);
+    vocabulary->hashes[id]  = hash;
+    vocabulary->offsets[id] = vocabulary->strings_size;
+    vocabulary->lengths[id] = (uint32_t)length;
+    memcpy(&vocabulary->strings[vocabulary->strings_size], word, length);
+    vocabulary->strings[vocabulary->strings_size + length] = 0;
+    vocabulary->strings_size += length + 1;
+
+    size_t mask = vocabulary->num_slots - 1;
+    size_t slot = hash & mask;
+    while (vocabulary->slots[slot] != 0)
+    {
+        slot = (slot + 1) & mask;
+    }
+    vocabulary->slots[slot] = id + 1;
+
+    return id;
+}
+
+const char *getWord(const vocabulary_t *vocabulary, uint32_t id, size_t *length)
+{
+    assert(id < vocabulary->num_words);
+    if (length)
+    {
+        *length = vocabulary->lengths[id];
+    }
+    return &vocabulary->strings[vocabulary->offsets[id]];
+}
+
+void buildSparseVector(uint32_t *ids, size_t num_ids, sparse_vector_t *vector)
+{
+    // sort ids in place, then run length encode into (id, count)
+    qsort(ids, num_ids, sizeof(uint32_t), compareIds);
+
+    vector->ids    = (uint32_t *)malloc((num_ids + 1) * sizeof(uint32_t));
+    vector->counts = (uint32_t *)malloc((num_ids + 1) * sizeof(uint32_t));
+    vector->size   = 0;
+    if (!vector->ids || !vector->counts)
+        assert(0);
+
+    for (size_t i = 0; i < num_ids; i++)
+    {
+        if (vector->size && vector->ids[vector->size - 1] == ids[i])
+        {
+            vector->counts[vector->size - 1]++;
+        }
+        else
+        {
+            vector->ids[vector->size]    = ids[i];
+            vector->counts[vector->size] = 1;
+            vector->size++;
+        }
+    }
+}
+
+void buildFrequencyVector(vocabulary_t *vocabulary, document *document, sparse_vector_t *vector)
+{
+    uint32_t *ids = (uint32_t *)malloc((document->num_words + 1) * sizeof(uint32_t));
+    if (!ids)
+        assert(0);
+
     for (size_t i = 0; i < document->num_words; i++)
     {
-        document->frequency[i] = 1;
+        char *word = &document->words[i * document->max_word_size];
+        ids[i]     = internWord(vocabulary, word, strlen(word));
     }
 
-    // check for frequencies by checking for duplicates
-    for (size_t curr = 0; curr < document->num_words; curr++)
+    buildSparseVector(ids, document->num_words, vector);
+    free(ids);
+}
+
+void buildTokenFrequencyVector(vocabulary_t *vocabulary, tokenizer_t *tokenizer, sparse_vector_t *vector)
+{
+    // per document open addressing table of (id + 1, count), sized to the distinct words seen
+    // so far; a short document costs a few slots however large the shared vocabulary is
+    count_table_t table;
+    initCountTable(&table, COUNT_TABLE_MIN_SLOTS);
+    size_t max_fold = VOCABULARY_MIN_WORDS;
+    char *fold      = (char *)malloc(max_fold);
+    if (!fold)
+        assert(0);
+
+    token_t token;
+    while (nextToken(tokenizer, &token))
     {
-        for (size_t search = curr + 1; search < document->num_words; search++)
+        uint32_t id;
+
+        // folded words go through a scratch buffer, everything else is interned straight from the view
+        if (tokenizer->fold_case)
         {
-            if (!strcmp(&document->words[curr * document->max_word_size], &document->words[search * document->max_word_size]))
+            if (token.length > max_fold)
             {
-                document->frequency[search] = 0;
-                document->frequency[curr]++;
-                document->words[search * document->max_word_size] = 0;
-                break;
+                while (token.length > max_fold)
+                {
+                    max_fold *= 2;
+                }
+                fold = (char *)realloc(fold, max_fold);
+                if (!fold)
+                    assert(0);
             }
+            foldTokenCase(&token, fold);
+            id = internWord(vocabulary, fold, token.length);
         }
+        else
+        {
+            id = internWord(vocabulary, token.ptr, token.length);
+        }
+
+        addCount(&table, id);
+    }
+
+    vector->ids    = (uint32_t *)malloc((table.size + 1) * sizeof(uint32_t));
+    vector->counts = (uint32_t *)malloc((table.size + 1) * sizeof(uint32_t));
+    vector->size   = table.size;
+    if (!vector->ids || !vector->counts)
+        assert(0);
+
+    size_t num_ids = 0;
+    for (size_t slot = 0; slot < table.num_slots; slot++)
+    {
+        if (table.keys[slot])
+            vector->ids[num_ids++] = table.keys[slot] - 1;
+    }
+    qsort(vector->ids, num_ids, sizeof(uint32_t), compareIds);
+    for (size_t i = 0; i < num_ids; i++)
+    {
+        vector->counts[i] = table.counts[findCountSlot(&table, vector->ids[i])];
     }
+
+    freeCountTable(&table);
+    free(fold);
 }
 
-uint32_t computeDotProduct(document *document1, document *document2)
+void initCountTable(count_table_t *table, size_t num_slots)
 {
-    uint32_t dot_product = 0;
+    table->num_slots = num_slots;
+    table->size      = 0;
+    table->keys      = (uint32_t *)calloc(num_slots, sizeof(uint32_t));
+    table->counts    = (uint32_t *)calloc(num_slots, sizeof(uint32_t));
+    if (!table->keys || !table->counts)
+        assert(0);
+}
 
-    for (size_t curr = 0; curr < document1->num_words; curr++)
+void freeCountTable(count_table_t *table)
+{
+    free(table->keys);
+    free(table->counts);
+    table->keys   = NULL;
+    table->counts = NULL;
+}
+
+// slot holding id, or the empty slot where it would go
+size_t findCountSlot(const count_table_t *table, uint32_t id)
+{
+    size_t mask = table->num_slots - 1;
+    size_t slot = (size_t)((id * HASH_MULTIPLIER) >> 32) & mask;
+    while (table->keys[slot] && (table->keys[slot] != id + 1))
+    {
+        slot = (slot + 1) & mask;
+    }
+
+    return slot;
+}
+
+void addCount(count_table_t *table, uint32_t id)
+{
+    size_t slot = findCountSlot(table, id);
+    if (table->keys[slot])
+    {
+        table->counts[slot]++;
+        return;
+    }
+
+    // kept at most half full, so probes stay short
+    if (2 * (table->size + 1) > table->num_slots)
     {
-        for (size_t ref = 0; ref < document2->num_words; ref++)
+        count_table_t grown;
+        initCountTable(&grown, 2 * table->num_slots);
+        for (size_t old = 0; old < table->num_slots; old++)
         {
-            if (!strcmp(&document1->words[curr * document1->max_word_size], &document2->words[ref * document2->max_word_size]))
-            {
-                dot_product += document1->frequency[curr] * document2->frequency[ref];
-                break;
-            }
+            if (!table->keys[old])
+                continue;
+            size_t moved        = findCountSlot(&grown, table->keys[old] - 1);
+            grown.keys[moved]    = table->keys[old];
+            grown.counts[moved]  = table->counts[old];
+        }
+        grown.size = table->size;
+        freeCountTable(table);
+        *table = grown;
+        slot   = findCountSlot(table, id);
+    }
+
+    table->keys[slot]   = id + 1;
+    table->counts[slot] = 1;
+    table->size++;
+}
+
+void freeSparseVector(sparse_vector_t *vector)
+{
+    free(vector->ids);
+    free(vector->counts);
+    vector->ids    = NULL;
+    vector->counts = NULL;
+    vector->size   = 0;
+}
+
+uint64_t computeSparseDotProduct(const sparse_vector_t *vector1, const sparse_vector_t *vector2)
+{
+    // merge the two ascending id lists
+    uint64_t dot_product = 0;
+    size_t pos1 = 0, pos2 = 0;
+    while ((pos1 < vector1->size) && (pos2 < vector2->size))
+    {
+        uint32_t id1 = vector1->ids[pos1];
+        uint32_t id2 = vector2->ids[pos2];
+        if (id1 == id2)
+        {
+            dot_product += (uint64_t)vector1->counts[pos1++] * vector2->counts[pos2++];
+        }
+        else if (id1 < id2)
+        {
+            pos1++;
+        }
+        else
+        {
+            pos2++;
         }
     }
 
     return dot_product;
-}
\ No newline at end of file
+}
+
+double computeVectorNorm(const sparse_vector_t *vector)
+{
+    uint64_t sum = 0;
+    for (size_t i = 0; i < vector->size; i++)
+    {
+        sum += (uint64_t)vector->counts[i] * vector->counts[i];
+    }
+
+    return sqrt((double)sum);
+}
+
+double computeCosineSimilarity(const sparse_vector_t *vector1, const sparse_vector_t *vector2)
+{
+    double norms = computeVectorNorm(vector1) * computeVectorNorm(vector2);
+    if (norms == 0.0)
+    {
+        return 0.0;
+    }
+
+    return computeSparseDotProduct(vector1, vector2) / norms;
+}
+
+double computeDocumentDistance(const sparse_vector_t *vector1, const sparse_vector_t *vector2)
+{
+    // angle between the frequency vectors, 0 for identical documents, pi/2 for disjoint ones
+    double similarity = computeCosineSimilarity(vector1, vector2);
+    if (similarity > 1.0)
+    {
+        similarity = 1.0;
+    }
+
+    return acos(similarity);
+}
+
+void growVocabulary(vocabulary_t *vocabulary)
+{
+    vocabulary->max_words *= 2;
+    vocabulary->hashes  = (uint64_t *)realloc(vocabulary->hashes, vocabulary->max_words * sizeof(uint64_t));
+    vocabulary->offsets = (size_t *)realloc(vocabulary->offsets, vocabulary->max_words * sizeof(size_t));
+    vocabulary->lengths = (uint32_t *)realloc(vocabulary->lengths, vocabulary->max_words * sizeof(uint32_t));
+    if (!vocabulary->hashes || !vocabulary->offsets || !vocabulary->lengths)
+        assert(0);
+
+    // rehash into a table twice the size, hashes are cached so words are not rehashed
+    free(vocabulary->slots);
+    vocabulary->num_slots = vocabulary->max_words * 2;
+    vocabulary->slots     = (uint32_t *)calloc(vocabulary->num_slots, sizeof(uint32_t));
+    if (!vocabulary->slots)
+        assert(0);
+
+    size_t mask = vocabulary->num_slots - 1;
+    for (size_t id = 0; id < vocabulary->num_words; id++)
+    {
+        size_t slot = vocabulary->hashes[id] & mask;
+        while (vocabulary->slots[slot] != 0)
+        {
+            slot = (slot + 1) & mask;
+        }
+        vocabulary->slots[slot] = (uint32_t)id + 1;
+    }
+}
+
+int compareIds(const void *id1, const void *id2)
+{
+    uint32_t lhs = *(const uint32_t *)id1;
+    uint32_t rhs = *(const uint32_t *)id2;
+
+    return (lhs > rhs) - (lhs < rhs);
+}
@@ -6,11 +6,15 @@
 // ************************************************
 // INCLUDES
 // ************************************************
+#include <stddef.h>
 #include <stdint.h>
 
+#include "tokenizer.h"
+
 // ************************************************
 // MACROS
 // ************************************************
+#define WORD_NOT_FOUND (-1)
 
 // ************************************************
 // TYPEDEF & ENUMS
@@ -25,9 +29,48 @@ typedef struct
     size_t max_num_words;
 } document;
 
+// open addressing table interning each distinct word to a dense id
+typedef struct
+{
+    uint32_t *slots;      // word id + 1, 0 marks an empty slot
+    size_t num_slots;     // power of two
+    uint64_t *hashes;     // per word id
+    size_t *offsets;      // per word id, into strings
+    uint32_t *lengths;    // per word id
+    size_t num_words;
+    size_t max_words;
+    char *strings;        // interned words, each NUL terminated
+    size_t strings_size;
+    size_t strings_capacity;
+} vocabulary_t;
+
+// word counts keyed by ascending word id
+typedef struct
+{
+    uint32_t *ids;
+    uint32_t *counts;
+    size_t size;
+} sparse_vector_t;
+
 // ************************************************
 // FUNCTION DECLARATIONS
 // ************************************************
 void splitDocument(document *document);
 void countWordFrequencies(document *document);
-uint32_t computeDotProduct(document *document1, document *document2);
\ No newline at end of file
+uint32_t computeDotProduct(document *document1, document *document2);
+
+uint64_t hashWord(const char *word, size_t length);
+void initVocabulary(vocabulary_t *vocabulary, size_t expected_words);
+void freeVocabulary(vocabulary_t *vocabulary);
+uint32_t internWord(vocabulary_t *vocabulary, const char *word, size_t length);
+int64_t findWord(const vocabulary_t *vocabulary, const char *word, size_t length);
+const char *getWord(const vocabulary_t *vocabulary, uint32_t id, size_t *length);
+
+void buildSparseVector(uint32_t *ids, size_t num_ids, sparse_vector_t *vector);
+void buildFrequencyVector(vocabulary_t *vocabulary, document *document, sparse_vector_t *vector);
+void buildTokenFrequencyVector(vocabulary_t *vocabulary, tokenizer_t *tokenizer, sparse_vector_t *vector);
+void freeSparseVector(sparse_vector_t *vector);
+uint64_t computeSparseDotProduct(const sparse_vector_t *vector1, const sparse_vector_t *vector2);
+double computeVectorNorm(const sparse_vector_t *vector);
+double computeCosineSimilarity(const sparse_vector_t *vector1, const sparse_vector_t *vector2);
+double computeDocumentDistance(const sparse_vector_t *vector1, const sparse_vector_t *vector2);
\ No newline at end of file
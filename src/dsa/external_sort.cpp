@@ -0,0 +1,329 @@
+// ************************************************
+// PRAGMAS
+// ************************************************
+#pragma once
+
+// ************************************************
+// INCLUDES
+// ************************************************
+#include "external_sort.h"
+#include "parallel_sort.h"
+#include <stdio.h>
+#include <future>
+#include <string>
+#include <vector>
+
+// ************************************************
+// MACROS
+// ************************************************
+#define EXTERNAL_SORT_RUN_BUFFERS 3    // run being sorted, its sort scratch, run being read / written
+
+// ************************************************
+// TYPEDEF & ENUMS
+// ************************************************
+// two blocks per run, one being consumed while the other is read in the background
+template <typename T>
+struct run_reader_t
+{
+    FILE *file;
+    T *blocks[2];
+    size_t sizes[2];
+    int current;
+    size_t pos;
+    std::future<size_t> pending;
+};
+
+// ************************************************
+// FUNCTION DECLARATIONS
+// ************************************************
+template <typename T>
+static bool externalSortKeys(const char *input_path, const char *output_path, const external_sort_config_t *config);
+template <typename T>
+static bool generateRuns(FILE *input, const std::string &prefix, size_t run_keys, unsigned num_threads,
+                         std::vector<std::string> &runs);
+template <typename T>
+static bool mergeRunFiles(const std::vector<std::string> &runs, const char *output_path, size_t block_keys);
+template <typename T>
+static size_t readKeys(FILE *file, T *keys, size_t count, bool *whole = NULL);
+template <typename T>
+static bool writeKeys(FILE *file, const T *keys, size_t count);
+static void removeRuns(const std::vector<std::string> &runs, size_t begin, size_t end);
+
+// ************************************************
+// FUNCTION DEFINITIONS
+// ************************************************
+bool externalSortFile32(const char *input_path, const char *output_path, const external_sort_config_t *config)
+{
+    return externalSortKeys<uint32_t>(input_path, output_path, config);
+}
+
+bool externalSortFile64(const char *input_path, const char *output_path, const external_sort_config_t *config)
+{
+    return externalSortKeys<uint64_t>(input_path, output_path, config);
+}
+
+// pass 1 writes sorted runs as large as memory allows, pass 2 merges all of them at once;
+// only when the fan-in would shrink read blocks below EXTERNAL_SORT_MIN_BLOCK do groups
+// of runs get merged first
+template <typename T>
+bool externalSortKeys(const char *input_path, const char *output_path, const external_sort_config_t *config)
+{
+    // the smallest merge, two runs into the output, needs two blocks of at least one key each
+    size_t run_keys    = config->memory_bytes / (EXTERNAL_SORT_RUN_BUFFERS * sizeof(T));
+    size_t memory_keys = config->memory_bytes / sizeof(T);
+    size_t min_block   = EXTERNAL_SORT_MIN_BLOCK / sizeof(T);
+    if ((run_keys == 0) || (memory_keys < 2 * (2 + 1)))
+        return false;
+
+    FILE *input = fopen(input_path, "rb");
+    if (!input)
+        return false;
+
+    std::vector<std::string> runs;
+    std::string prefix = std::string(output_path) + ".run";
+    bool ok            = generateRuns<T>(input, prefix, run_keys, config->num_threads, runs);
+    fclose(input);
+    if (!ok)
+    {
+        removeRuns(runs, 0, runs.size());
+        return false;
+    }
+
+    // a single run is already the output
+    if (runs.size() <= 1)
+    {
+        if (runs.empty())
+        {
+            FILE *output = fopen(output_path, "wb");
+            return output && (fclose(output) == 0);
+        }
+        remove(output_path);
+        ok = (rename(runs[0].c_str(), output_path) == 0);
+        removeRuns(runs, 0, runs.size());
+        return ok;
+    }
+
+    // every run and the output get two blocks
+    size_t max_fan_in = memory_keys / (2 * min_block);
+    max_fan_in        = (max_fan_in > 3) ? (max_fan_in - 1) : 2;
+
+    size_t first = 0;
+    while (runs.size() - first > max_fan_in)
+    {
+        size_t end         = std::min(runs.size(), first + max_fan_in);
+        std::string merged = prefix + std::to_string(runs.size());
+        std::vector<std::string> group(runs.begin() + first, runs.begin() + end);
+        ok = mergeRunFiles<T>(group, merged.c_str(), memory_keys / (2 * (group.size() + 1)));
+        removeRuns(runs, first, end);
+        runs.push_back(merged);
+        first = end;
+        if (!ok)
+            break;
+    }
+
+    if (ok)
+    {
+        std::vector<std::string> group(runs.begin() + first, runs.end());
+        ok = mergeRunFiles<T>(group, output_path, memory_keys / (2 * (group.size() + 1)));
+    }
+    removeRuns(runs, first, runs.size());
+
+    return ok;
+}
+
+// the sorted run is written in the background while the next one is read
+template <typename T>
+bool generateRuns(FILE *input, const std::string &prefix, size_t run_keys, unsigned num_threads,
+                  std::vector<std::string> &runs)
+{
+    std::vector<T> buffers[2];
+    buffers[0].resize(run_keys);
+    buffers[1].resize(run_keys);
+
+    std::future<bool> pending;
+    bool ok     = true;
+    int current = 0;
+    size_t size = readKeys(input, buffers[current].data(), run_keys, &ok);
+    while (ok && (size > 0))
+    {
+        parallelSort(buffers[current].data(), size, std::less<T>(), false, num_threads);
+
+        if (pending.valid())
+            ok &= pending.get();
+        if (!ok)
+            break;
+
+        runs.push_back(prefix + std::to_string(runs.size()));
+        const T *keys    = buffers[current].data();
+        std::string path = runs.back();
+        pending          = std::async(std::launch::async, [keys, size, path]() -> bool {
+            FILE *file = fopen(path.c_str(), "wb");
+            if (!file)
+                return false;
+            bool written = writeKeys(file, keys, size);
+            return (fclose(file) == 0) && written;
+        });
+
+        current ^= 1;
+        size = readKeys(input, buffers[current].data(), run_keys, &ok);
+    }
+    if (pending.valid())
+        ok &= pending.get();
+
+    return ok && !ferror(input);
+}
+
+template <typename T>
+static bool nextBlock(run_reader_t<T> *reader, size_t block_keys)
+{
+    // swap in the block read in the background and start on the one just used up
+    reader->sizes[reader->current ^ 1] = reader->pending.get();
+    reader->current ^= 1;
+    reader->pos = 0;
+    if (reader->sizes[reader->current] == 0)
+        return false;
+
+    FILE *file    = reader->file;
+    T *next_block = reader->blocks[reader->current ^ 1];
+    reader->pending =
+        std::async(std::launch::async, [file, next_block, block_keys]() { return readKeys(file, next_block, block_keys); });
+
+    return true;
+}
+
+// k-way merge through a loser tree: tree[0] holds the winning run, tree[1..k) the loser of
+// each match, so replacing the winner replays only the log2(k) matches on its path
+template <typename T>
+bool mergeRunFiles(const std::vector<std::string> &runs, const char *output_path, size_t block_keys)
+{
+    size_t k = runs.size();
+    if (block_keys == 0)
+        return false;
+
+    std::vector<T> memory((2 * k + 2) * block_keys);
+    std::vector<run_reader_t<T> > readers(k);
+    std::vector<bool> exhausted(k + 1, false);
+    bool ok = true;
+
+    for (size_t run = 0; run < k; run++)
+    {
+        run_reader_t<T> *reader = &readers[run];
+        reader->file            = fopen(runs[run].c_str(), "rb");
+        reader->blocks[0]       = &memory[2 * run * block_keys];
+        reader->blocks[1]       = &memory[(2 * run + 1) * block_keys];
+        reader->current         = 1;
+        ok &= (reader->file != NULL);
+        if (!ok)
+            break;
+
+        FILE *file      = reader->file;
+        T *block        = reader->blocks[0];
+        reader->pending = std::async(std::launch::deferred, [file, block, block_keys]() {
+            return readKeys(file, block, block_keys);
+        });
+        exhausted[run] = !nextBlock(reader, block_keys);
+    }
+
+    FILE *output = ok ? fopen(output_path, "wb") : NULL;
+    if (output)
+    {
+        // a run beats another with a smaller key, exhausted runs lose to everything,
+        // leaf k stands for minus infinity while the tree is built
+        std::vector<size_t> tree(k, k);
+        auto beats = [&](size_t a, size_t b) -> bool {
+            if ((a == k) || (b == k))
+                return a == k;
+            if (exhausted[a] || exhausted[b])
+                return !exhausted[a] && exhausted[b];
+            T key_a = readers[a].blocks[readers[a].current][readers[a].pos];
+            T key_b = readers[b].blocks[readers[b].current][readers[b].pos];
+            return (key_a < key_b) || ((key_a == key_b) && (a < b));
+        };
+        auto replay = [&](size_t winner) {
+            for (size_t node = (winner + k) / 2; node > 0; node /= 2)
+            {
+                if (beats(tree[node], winner))
+                    std::swap(tree[node], winner);
+            }
+            tree[0] = winner;
+        };
+        for (size_t run = k; run > 0; run--)
+        {
+            replay(run - 1);
+        }
+
+        T *out_blocks[2] = {&memory[2 * k * block_keys], &memory[(2 * k + 1) * block_keys]};
+        int out_current  = 0;
+        size_t out_size  = 0;
+        std::future<bool> pending_write;
+
+        while (!exhausted[tree[0]])
+        {
+            size_t winner           = tree[0];
+            run_reader_t<T> *reader = &readers[winner];
+            out_blocks[out_current][out_size++] = reader->blocks[reader->current][reader->pos++];
+            if (reader->pos == reader->sizes[reader->current])
+                exhausted[winner] = !nextBlock(reader, block_keys);
+            replay(winner);
+
+            if (out_size == block_keys)
+            {
+                if (pending_write.valid())
+                    ok &= pending_write.get();
+                const T *block = out_blocks[out_current];
+                pending_write  = std::async(std::launch::async, [output, block, out_size]() {
+                    return writeKeys(output, block, out_size);
+                });
+                out_current ^= 1;
+                out_size = 0;
+            }
+        }
+
+        if (pending_write.valid())
+            ok &= pending_write.get();
+        ok &= writeKeys(output, out_blocks[out_current], out_size);
+        ok &= (fclose(output) == 0);
+    }
+    else
+    {
+        ok = false;
+    }
+
+    for (size_t run = 0; run < k; run++)
+    {
+        if (readers[run].pending.valid())
+            readers[run].pending.wait();
+        if (readers[run].file)
+        {
+            ok &= !ferror(readers[run].file);
+            fclose(readers[run].file);
+        }
+    }
+
+    return ok;
+}
+
+// whole, when given, is cleared if the file ends inside a key; fread would drop it silently
+template <typename T>
+size_t readKeys(FILE *file, T *keys, size_t count, bool *whole)
+{
+    size_t bytes = fread(keys, 1, count * sizeof(T), file);
+    if (whole && (bytes % sizeof(T) != 0))
+        *whole = false;
+
+    return bytes / sizeof(T);
+}
+
+template <typename T>
+bool writeKeys(FILE *file, const T *keys, size_t count)
+{
+    return fwrite(keys, sizeof(T), count, file) == count;
+}
+
+void removeRuns(const std::vector<std::string> &runs, size_t begin, size_t end)
+{
+    for (size_t run = begin; run < end; run++)
+    {
+        remove(runs[run].c_str());
+    }
+}
@@ -0,0 +1,31 @@
+// ************************************************
+// PRAGMAS
+// ************************************************
+#pragma once
+
+// ************************************************
+// INCLUDES
+// ************************************************
+#include <stddef.h>
+#include <stdint.h>
+
+// ************************************************
+// MACROS
+// ************************************************
+#define EXTERNAL_SORT_MIN_BLOCK (1 << 20)    // smallest read block in bytes before merging takes extra passes
+
+// ************************************************
+// TYPEDEF & ENUMS
+// ************************************************
+typedef struct
+{
+    size_t memory_bytes;     // key buffers in total, run size and merge fan-in follow from it
+    unsigned num_threads;    // 0 uses every core
+} external_sort_config_t;
+
+// ************************************************
+// FUNCTION DECLARATIONS
+// ************************************************
+// flat native endian key files, runs are written next to output_path and removed afterwards
+bool externalSortFile32(const char *input_path, const char *output_path, const external_sort_config_t *config);
+bool externalSortFile64(const char *input_path, const char *output_path, const external_sort_config_t *config);
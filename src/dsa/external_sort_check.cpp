@@ -0,0 +1,163 @@
+// ************************************************
+// INCLUDES
+// ************************************************
+#include "external_sort.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+
+// ************************************************
+// MACROS
+// ************************************************
+#define CHECK_INPUT  "external_sort_check.in"
+#define CHECK_OUTPUT "external_sort_check.out"
+
+// ************************************************
+// TYPEDEF & ENUMS
+// ************************************************
+
+// ************************************************
+// GLOBALS
+// ************************************************
+static uint64_t check_seed = 98765;
+
+// ************************************************
+// FUNCTION DECLARATIONS
+// ************************************************
+static uint64_t checkRandom(void);
+template <typename T>
+static bool writeInput(const std::vector<T> &keys, size_t extra_bytes);
+template <typename T>
+static bool readOutput(std::vector<T> &keys);
+template <typename T>
+static bool checkRoundTrip(const char *name, bool (*sort)(const char *, const char *, const external_sort_config_t *),
+                           size_t size, uint64_t range, size_t memory_bytes);
+static bool checkRejected(const char *name, size_t size, size_t extra_bytes, size_t memory_bytes);
+static bool report(const char *name, size_t size, size_t memory_bytes, bool same);
+
+// ************************************************
+// FUNCTION DEFINITIONS
+// ************************************************
+// ./external_sort_check_exe, non-zero exit when a sorted file differs from std::sort; runs in
+// the working directory and removes its files
+int main()
+{
+    bool ok = true;
+
+    // one run, a direct merge and small budgets that need intermediate merge passes
+    ok &= checkRoundTrip<uint32_t>("externalSortFile32", externalSortFile32, 0, 0, 1 << 16);
+    ok &= checkRoundTrip<uint32_t>("externalSortFile32", externalSortFile32, 1, 0, 1 << 16);
+    ok &= checkRoundTrip<uint32_t>("externalSortFile32", externalSortFile32, 100000, 0, 16 << 20);
+    ok &= checkRoundTrip<uint32_t>("externalSortFile32", externalSortFile32, 100000, 0, 1 << 16);
+    ok &= checkRoundTrip<uint32_t>("externalSortFile32", externalSortFile32, 100000, 7, 1 << 12);
+    ok &= checkRoundTrip<uint32_t>("externalSortFile32", externalSortFile32, 1000, 0, 24);
+    ok &= checkRoundTrip<uint64_t>("externalSortFile64", externalSortFile64, 50000, 0, 1 << 15);
+    ok &= checkRoundTrip<uint64_t>("externalSortFile64", externalSortFile64, 50000, 3, 1 << 20);
+
+    // a file ending inside a key, and budgets without room for two runs and the output
+    ok &= checkRejected("partial key", 1000, 2, 1 << 16);
+    ok &= checkRejected("tiny budget", 100, 0, 12);
+    ok &= checkRejected("tiny budget", 100, 0, 20);
+    ok &= checkRejected("no budget", 100, 0, 0);
+
+    remove(CHECK_INPUT);
+    remove(CHECK_OUTPUT);
+    printf("external_sort_check: %s\n", ok ? "ok" : "FAILED");
+
+    return ok ? 0 : 1;
+}
+
+uint64_t checkRandom(void)
+{
+    // xorshift64, the same sequence on every platform
+    check_seed ^= check_seed << 13;
+    check_seed ^= check_seed >> 7;
+    check_seed ^= check_seed << 17;
+
+    return check_seed;
+}
+
+template <typename T>
+bool writeInput(const std::vector<T> &keys, size_t extra_bytes)
+{
+    // extra_bytes of a key that never ends
+    static const char partial[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+    FILE *file                   = fopen(CHECK_INPUT, "wb");
+    if (!file)
+        return false;
+
+    bool ok = (keys.empty() || (fwrite(keys.data(), sizeof(T), keys.size(), file) == keys.size()));
+    ok &= (extra_bytes == 0) || (fwrite(partial, 1, extra_bytes, file) == extra_bytes);
+
+    return (fclose(file) == 0) && ok;
+}
+
+template <typename T>
+bool readOutput(std::vector<T> &keys)
+{
+    FILE *file = fopen(CHECK_OUTPUT, "rb");
+    if (!file)
+        return false;
+
+    T key;
+    keys.clear();
+    while (fread(&key, sizeof(T), 1, file) == 1)
+    {
+        keys.push_back(key);
+    }
+    bool ok = !ferror(file) && (fgetc(file) == EOF);
+    fclose(file);
+
+    return ok;
+}
+
+template <typename T>
+bool checkRoundTrip(const char *name, bool (*sort)(const char *, const char *, const external_sort_config_t *),
+                    size_t size, uint64_t range, size_t memory_bytes)
+{
+    // range 0 is every value of T
+    std::vector<T> keys(size);
+    for (size_t i = 0; i < size; i++)
+    {
+        uint64_t value = checkRandom();
+        keys[i]        = (T)(range ? value % range : value);
+    }
+
+    external_sort_config_t config;
+    config.memory_bytes = memory_bytes;
+    config.num_threads  = 2;
+
+    std::vector<T> sorted;
+    remove(CHECK_OUTPUT);
+    bool ok = writeInput(keys, 0) && sort(CHECK_INPUT, CHECK_OUTPUT, &config) && readOutput(sorted);
+    std::sort(keys.begin(), keys.end());
+
+    return report(name, size, memory_bytes, ok && (sorted == keys));
+}
+
+bool checkRejected(const char *name, size_t size, size_t extra_bytes, size_t memory_bytes)
+{
+    std::vector<uint32_t> keys(size);
+    for (size_t i = 0; i < size; i++)
+    {
+        keys[i] = (uint32_t)checkRandom();
+    }
+
+    external_sort_config_t config;
+    config.memory_bytes = memory_bytes;
+    config.num_threads  = 2;
+
+    bool written = writeInput(keys, extra_bytes);
+
+    return report(name, size, memory_bytes, written && !externalSortFile32(CHECK_INPUT, CHECK_OUTPUT, &config));
+}
+
+bool report(const char *name, size_t size, size_t memory_bytes, bool same)
+{
+    if (!same)
+        fprintf(stderr, "%s failed for %zu keys in %zu bytes\n", name, size, memory_bytes);
+
+    return same;
+}
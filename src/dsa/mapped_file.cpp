@@ -0,0 +1,134 @@
+// ************************************************
+// PRAGMAS
+// ************************************************
+#pragma once
+
+// ************************************************
+// INCLUDES
+// ************************************************
+#include "mapped_file.h"
+#include <string.h>
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+// ************************************************
+// MACROS
+// ************************************************
+
+// ************************************************
+// TYPEDEF & ENUMS
+// ************************************************
+
+// ************************************************
+// FUNCTION DECLARATIONS
+// ************************************************
+
+// ************************************************
+// FUNCTION DEFINITIONS
+// ************************************************
+#ifdef _WIN32
+bool mapFile(mapped_file_t *file, const char *path)
+{
+    memset(file, 0, sizeof(*file));
+
+    HANDLE file_handle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                                     FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file_handle == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file_handle, &size))
+    {
+        CloseHandle(file_handle);
+        return false;
+    }
+
+    file->file_handle = file_handle;
+    file->size        = (size_t)size.QuadPart;
+    if (file->size == 0)
+        return true;
+
+    HANDLE mapping_handle = CreateFileMappingA(file_handle, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mapping_handle == NULL)
+    {
+        CloseHandle(file_handle);
+        memset(file, 0, sizeof(*file));
+        return false;
+    }
+
+    file->mapping_handle = mapping_handle;
+    file->data           = (const char *)MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0);
+    if (file->data == NULL)
+    {
+        CloseHandle(mapping_handle);
+        CloseHandle(file_handle);
+        memset(file, 0, sizeof(*file));
+        return false;
+    }
+
+    return true;
+}
+
+void unmapFile(mapped_file_t *file)
+{
+    if (file->data)
+        UnmapViewOfFile(file->data);
+    if (file->mapping_handle)
+        CloseHandle((HANDLE)file->mapping_handle);
+    if (file->file_handle)
+        CloseHandle((HANDLE)file->file_handle);
+    memset(file, 0, sizeof(*file));
+}
+#else
+bool mapFile(mapped_file_t *file, const char *path)
+{
+    memset(file, 0, sizeof(*file));
+
+    file->fd = open(path, O_RDONLY);
+    if (file->fd < 0)
+        return false;
+
+    struct stat info;
+    if (fstat(file->fd, &info) != 0)
+    {
+        close(file->fd);
+        file->fd = -1;
+        return false;
+    }
+
+    file->size = (size_t)info.st_size;
+    if (file->size == 0)
+        return true;
+
+    void *data = mmap(NULL, file->size, PROT_READ, MAP_PRIVATE, file->fd, 0);
+    if (data == MAP_FAILED)
+    {
+        close(file->fd);
+        file->fd   = -1;
+        file->size = 0;
+        return false;
+    }
+
+    // corpora are scanned front to back, let the kernel read ahead aggressively
+    madvise(data, file->size, MADV_SEQUENTIAL);
+    file->data = (const char *)data;
+
+    return true;
+}
+
+void unmapFile(mapped_file_t *file)
+{
+    if (file->data)
+        munmap((void *)file->data, file->size);
+    if (file->fd >= 0)
+        close(file->fd);
+    memset(file, 0, sizeof(*file));
+    file->fd = -1;
+}
+#endif
@@ -0,0 +1,36 @@
+// ************************************************
+// PRAGMAS
+// ************************************************
+#pragma once
+
+// ************************************************
+// INCLUDES
+// ************************************************
+#include <stddef.h>
+#include <stdint.h>
+
+// ************************************************
+// MACROS
+// ************************************************
+
+// ************************************************
+// TYPEDEF & ENUMS
+// ************************************************
+// read only view of a whole file, data is NULL for empty files
+typedef struct
+{
+    const char *data;
+    size_t size;
+#ifdef _WIN32
+    void *file_handle;
+    void *mapping_handle;
+#else
+    int fd;
+#endif
+} mapped_file_t;
+
+// ************************************************
+// FUNCTION DECLARATIONS
+// ************************************************
+bool mapFile(mapped_file_t *file, const char *path);
+void unmapFile(mapped_file_t *file);
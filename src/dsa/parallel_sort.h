@@ -0,0 +1,314 @@
+// ************************************************
+// PRAGMAS
+// ************************************************
+#pragma once
+
+// ************************************************
+// INCLUDES
+// ************************************************
+#include "work_stealing.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+// ************************************************
+// MACROS
+// ************************************************
+#define INTROSORT_LEAF         16       // insertion sort below this
+#define STABLE_SORT_LEAF       32       // insertion sort runs of the stable merge sort
+#define PARALLEL_SORT_MIN      65536    // below this one thread sorts everything
+#define PARALLEL_SORT_CHUNKS   4        // leaf chunks per thread, spare ones balance the load
+#define PARALLEL_MERGE_PIECE   16384    // minimum keys merged by one task
+
+// ************************************************
+// TYPEDEF & ENUMS
+// ************************************************
+// T must be default constructible and movable, compare is a strict weak ordering
+template <typename T, typename compare_t>
+struct sort_context_t
+{
+    T *keys;
+    T *buffer;
+    size_t size;
+    size_t chunk;    // keys per leaf chunk
+    size_t run;      // sorted run length of the current merge round
+    size_t piece;    // output keys per merge task
+    T *src;
+    T *dst;
+    compare_t compare;
+    bool stable;
+};
+
+// ************************************************
+// FUNCTION DECLARATIONS
+// ************************************************
+template <typename T, typename compare_t>
+void introSort(T *keys, size_t size, compare_t compare);
+template <typename T, typename compare_t>
+void stableSort(T *keys, T *buffer, size_t size, compare_t compare);
+template <typename T, typename compare_t>
+void parallelSort(T *keys, size_t size, compare_t compare, bool stable, unsigned num_threads);
+template <typename T>
+void parallelSort(T *keys, size_t size);
+
+// ************************************************
+// FUNCTION DEFINITIONS
+// ************************************************
+template <typename T, typename compare_t>
+void insertionSortRange(T *keys, size_t size, compare_t compare)
+{
+    for (size_t init_pos = 1; init_pos < size; ++init_pos)
+    {
+        T value          = std::move(keys[init_pos]);
+        size_t final_pos = init_pos;
+        while ((final_pos > 0) && compare(value, keys[final_pos - 1]))
+        {
+            keys[final_pos] = std::move(keys[final_pos - 1]);
+            final_pos--;
+        }
+        keys[final_pos] = std::move(value);
+    }
+}
+
+template <typename T, typename compare_t>
+void siftDown(T *keys, size_t root, size_t size, compare_t compare)
+{
+    T value = std::move(keys[root]);
+    for (size_t child = 2 * root + 1; child < size; child = 2 * root + 1)
+    {
+        if ((child + 1 < size) && compare(keys[child], keys[child + 1]))
+            child++;
+        if (!compare(value, keys[child]))
+            break;
+        keys[root] = std::move(keys[child]);
+        root       = child;
+    }
+    keys[root] = std::move(value);
+}
+
+template <typename T, typename compare_t>
+void heapSort(T *keys, size_t size, compare_t compare)
+{
+    for (size_t root = size / 2; root > 0; root--)
+    {
+        siftDown(keys, root - 1, size, compare);
+    }
+    for (size_t end = size; end > 1; end--)
+    {
+        std::swap(keys[0], keys[end - 1]);
+        siftDown(keys, 0, end - 1, compare);
+    }
+}
+
+template <typename T, typename compare_t>
+void introSortLoop(T *keys, size_t size, size_t depth, compare_t compare)
+{
+    while (size > INTROSORT_LEAF)
+    {
+        // too many bad pivots, the heap sort bound keeps the worst case at n log n
+        if (depth == 0)
+        {
+            heapSort(keys, size, compare);
+            return;
+        }
+        depth--;
+
+        // median of three to the front, the other two then bound both partition scans
+        T *a = &keys[1], *b = &keys[size / 2], *c = &keys[size - 1];
+        if (compare(*b, *a))
+            std::swap(a, b);
+        if (compare(*c, *b))
+            b = compare(*c, *a) ? a : c;
+        std::swap(keys[0], *b);
+
+        size_t lo = 1, hi = size;
+        while (true)
+        {
+            while (compare(keys[lo], keys[0]))
+                lo++;
+            hi--;
+            while (compare(keys[0], keys[hi]))
+                hi--;
+            if (lo >= hi)
+                break;
+            std::swap(keys[lo], keys[hi]);
+            lo++;
+        }
+
+        // recurse into the right part, loop on the left
+        introSortLoop(keys + lo, size - lo, depth, compare);
+        size = lo;
+    }
+    insertionSortRange(keys, size, compare);
+}
+
+template <typename T, typename compare_t>
+void introSort(T *keys, size_t size, compare_t compare)
+{
+    size_t depth = 0;
+    for (size_t n = size; n > 1; n >>= 1)
+    {
+        depth += 2;
+    }
+    introSortLoop(keys, size, depth, compare);
+}
+
+// stable, takes from run1 unless run2 is strictly smaller
+template <typename T, typename compare_t>
+void mergeRuns(T *run1, size_t size1, T *run2, size_t size2, T *dst, compare_t compare)
+{
+    size_t i = 0, j = 0;
+    while ((i < size1) && (j < size2))
+    {
+        if (compare(run2[j], run1[i]))
+            *dst++ = std::move(run2[j++]);
+        else
+            *dst++ = std::move(run1[i++]);
+    }
+    dst = std::move(&run1[i], &run1[size1], dst);
+    std::move(&run2[j], &run2[size2], dst);
+}
+
+template <typename T, typename compare_t>
+void stableSort(T *keys, T *buffer, size_t size, compare_t compare)
+{
+    // buffer holds at least size keys
+    if (size <= STABLE_SORT_LEAF)
+    {
+        insertionSortRange(keys, size, compare);
+        return;
+    }
+
+    size_t half = size / 2;
+    stableSort(keys, buffer, half, compare);
+    stableSort(keys + half, buffer + half, size - half, compare);
+    if (!compare(keys[half], keys[half - 1]))
+        return;    // already in order
+
+    mergeRuns(keys, half, keys + half, size - half, buffer, compare);
+    std::move(buffer, buffer + size, keys);
+}
+
+// number of keys run1 contributes to the first k merged keys
+template <typename T, typename compare_t>
+size_t coRank(const T *run1, size_t size1, const T *run2, size_t size2, size_t k, compare_t compare)
+{
+    size_t lo = (k > size2) ? (k - size2) : 0;
+    size_t hi = (k < size1) ? k : size1;
+    while (lo < hi)
+    {
+        size_t i = (lo + hi) / 2;
+        size_t j = k - i;
+        if ((j > 0) && !compare(run2[j - 1], run1[i]))
+            lo = i + 1;
+        else
+            hi = i;
+    }
+
+    return lo;
+}
+
+template <typename T, typename compare_t>
+void sortChunks(size_t begin, size_t end, unsigned worker, void *context)
+{
+    (void)worker;
+    sort_context_t<T, compare_t> *sort = (sort_context_t<T, compare_t> *)context;
+    for (size_t chunk = begin; chunk < end; chunk++)
+    {
+        size_t start = chunk * sort->chunk;
+        size_t size  = std::min(sort->chunk, sort->size - start);
+        if (sort->stable)
+            stableSort(sort->keys + start, sort->buffer + start, size, sort->compare);
+        else
+            introSort(sort->keys + start, size, sort->compare);
+    }
+}
+
+// each piece is a fixed slice of the output, found in both runs by co-ranking,
+// so even the final merge of two halves spreads over every thread
+template <typename T, typename compare_t>
+void mergePieces(size_t begin, size_t end, unsigned worker, void *context)
+{
+    (void)worker;
+    sort_context_t<T, compare_t> *sort = (sort_context_t<T, compare_t> *)context;
+    size_t out_begin                   = begin * sort->piece;
+    size_t out_end                     = std::min(sort->size, end * sort->piece);
+    while (out_begin < out_end)
+    {
+        size_t pair_start = out_begin - out_begin % (2 * sort->run);
+        size_t pair_end   = std::min(sort->size, pair_start + 2 * sort->run);
+        size_t seg_end    = std::min(out_end, pair_end);
+
+        T *run1      = sort->src + pair_start;
+        size_t size1 = std::min(sort->run, sort->size - pair_start);
+        T *run2      = run1 + size1;
+        size_t size2 = pair_end - pair_start - size1;
+
+        size_t k0 = out_begin - pair_start;
+        size_t k1 = seg_end - pair_start;
+        size_t i0 = coRank(run1, size1, run2, size2, k0, sort->compare);
+        size_t i1 = coRank(run1, size1, run2, size2, k1, sort->compare);
+        mergeRuns(run1 + i0, i1 - i0, run2 + (k0 - i0), (k1 - i1) - (k0 - i0), sort->dst + out_begin, sort->compare);
+
+        out_begin = seg_end;
+    }
+}
+
+template <typename T, typename compare_t>
+void moveBack(size_t begin, size_t end, unsigned worker, void *context)
+{
+    (void)worker;
+    sort_context_t<T, compare_t> *sort = (sort_context_t<T, compare_t> *)context;
+    size_t out_begin                   = begin * sort->piece;
+    size_t out_end                     = std::min(sort->size, end * sort->piece);
+    std::move(sort->src + out_begin, sort->src + out_end, sort->keys + out_begin);
+}
+
+// sorted chunks in parallel (introsort, or merge sort when stable), then log2(chunks)
+// rounds of merges split into equal output pieces
+template <typename T, typename compare_t>
+void parallelSort(T *keys, size_t size, compare_t compare, bool stable, unsigned num_threads)
+{
+    num_threads = resolveThreadCount(num_threads);
+    if ((num_threads == 1) || (size < PARALLEL_SORT_MIN))
+    {
+        if (stable)
+        {
+            std::vector<T> buffer(size);
+            stableSort(keys, buffer.data(), size, compare);
+        }
+        else
+        {
+            introSort(keys, size, compare);
+        }
+        return;
+    }
+
+    std::vector<T> buffer(size);
+    size_t num_chunks = (size_t)num_threads * PARALLEL_SORT_CHUNKS;
+
+    sort_context_t<T, compare_t> sort = {keys, buffer.data(), size, 0, 0, 0, keys, buffer.data(), compare, stable};
+    sort.chunk                        = (size + num_chunks - 1) / num_chunks;
+    sort.piece                        = std::max((size_t)PARALLEL_MERGE_PIECE, size / num_chunks);
+    num_chunks                        = (size + sort.chunk - 1) / sort.chunk;
+    size_t num_pieces                 = (size + sort.piece - 1) / sort.piece;
+
+    parallelFor(num_chunks, 1, sortChunks<T, compare_t>, &sort, num_threads);
+
+    for (sort.run = sort.chunk; sort.run < size; sort.run *= 2)
+    {
+        parallelFor(num_pieces, 1, mergePieces<T, compare_t>, &sort, num_threads);
+        std::swap(sort.src, sort.dst);
+    }
+
+    if (sort.src != keys)
+        parallelFor(num_pieces, 1, moveBack<T, compare_t>, &sort, num_threads);
+}
+
+template <typename T>
+void parallelSort(T *keys, size_t size)
+{
+    parallelSort(keys, size, std::less<T>(), false, 0);
+}
@@ -21,7 +21,6 @@
 // ************************************************
 // FUNCTION DECLARATIONS
 // ************************************************
-static uint32_t findMatrixColumnMax(matrix_t matrix, uint32_t col);
 
 // ************************************************
 // FUNCTION DEFINITIONS
@@ -46,26 +45,17 @@ void printArray(array_t array)
 
 uint32_t find1DPeakStraightforward(array_t array)
 {
-    printArray(array);
-
-    // check first & last elements first
-    if (array.addr[0] > array.addr[1])
-    {
-        return array.addr[0];
-    }
-    else if (array.addr[array.size - 1] > array.addr[array.size - 2])
+    if (array.size == 0)
     {
-        return array.addr[array.size - 1];
+        return NOT_FOUND;
     }
 
-    // check remaining ones
-    for (int i = 1; i < array.size - 2; ++i)
+    // first element whose neighbours are not larger, the ends have one neighbour only
+    for (size_t i = 0; i < array.size; ++i)
     {
-        uint32_t left_value   = array.addr[i - 1];
         uint32_t centre_value = array.addr[i];
-        uint32_t right_value  = array.addr[i + 1];
-
-        if ((centre_value >= left_value) && (centre_value >= right_value))
+        if (((i == 0) || (centre_value >= array.addr[i - 1])) &&
+            ((i == array.size - 1) || (centre_value >= array.addr[i + 1])))
         {
             return centre_value;
         }
@@ -76,58 +66,9 @@ uint32_t find1DPeakStraightforward(array_t array)
 
 uint32_t find1DPeakDivideConquer(array_t array)
 {
-    size_t midpoint  = array.size / 2;
-    size_t new_start = 0;
-    size_t new_end   = array.size;
-
-    printArray(array);
-
-    // check first & last elements first
-    if (array.addr[0] > array.addr[1])
-    {
-        return array.addr[0];
-    }
-    else if (array.addr[array.size - 1] > array.addr[array.size - 2])
-    {
-        return array.addr[array.size - 1];
-    }
-
-    if (array.size > 2)
-    {
-        uint32_t left_value   = array.addr[midpoint - 1];
-        uint32_t centre_value = array.addr[midpoint];
-        uint32_t right_value  = array.addr[midpoint + 1];
-
-        if (left_value > centre_value)    // check left first
-        {
-            new_end = midpoint;
-        }
-        else if (right_value > centre_value)    // then check right
-        {
-            new_start = midpoint;
-        }
-        else    // midpoint is the peak
-        {
-            return array.addr[midpoint];
-        }
-    }
-    else
-    {
-        return NOT_FOUND;
-    }
+    size_t peak = find1DPeakIndex(array.addr, array.size);
 
-    // search peak in new subarray
-    array_t new_array = {0, new_end - new_start + 1};
-    new_array.addr    = (uint8_t *)malloc(new_array.size);
-    for (size_t i = 0; i < new_array.size; i++)
-    {
-        new_array.addr[i] = array.addr[new_start + i];
-    }
-    uint32_t peak = find1DPeakDivideConquer(new_array);
-
-    free(new_array.addr);
-
-    return peak;
+    return (peak == (size_t)NOT_FOUND) ? (uint32_t)NOT_FOUND : (uint32_t)array.addr[peak];
 }
 
 void fillMatrix(matrix_t matrix)
@@ -137,7 +78,7 @@ void fillMatrix(matrix_t matrix)
     {
         for (size_t col = 0; col < matrix.width; col++)
         {
-            matrix.addr[row * matrix.width + col] = rand() % RAND_MAX;
+            matrix.addr[row * matrix.stride + col] = rand() % RAND_MAX;
         }
     }
 }
@@ -148,7 +89,7 @@ void printMatrix(matrix_t matrix)
     {
         for (size_t col = 0; col < matrix.width; col++)
         {
-            printf("%4d ", matrix.addr[row * matrix.width + col]);
+            printf("%4d ", matrix.addr[row * matrix.stride + col]);
         }
         printf("\n");
     }
@@ -156,62 +97,52 @@ void printMatrix(matrix_t matrix)
 
 uint32_t find2DPeakGreedyAscent(matrix_t matrix)
 {
-    printMatrix(matrix);
+    if ((matrix.width == 0) || (matrix.height == 0))
+    {
+        return NOT_FOUND;
+    }
 
-    point2d_t position = {matrix.height / 2, matrix.width / 2};
+    point2d_t position = {(int32_t)(matrix.height / 2), (int32_t)(matrix.width / 2)};
 
     while (1)
     {
-        int32_t centre_value = matrix.addr[position.row * matrix.width + position.col];
+        uint8_t *centre      = &matrix.addr[position.row * matrix.stride + position.col];
+        int32_t centre_value = *centre;
         int32_t left_value, right_value, up_value, down_value;
 
-        printf("%4d ", centre_value);
-
         // init all neighbors
         left_value = right_value = up_value = down_value = INVALID;
 
         // check for edges
         if (position.col > 0)
-            left_value = matrix.addr[position.row * matrix.width + (position.col - 1)];
-        if (position.col < (matrix.width - 1))
-            right_value = matrix.addr[position.row * matrix.width + (position.col + 1)];
+            left_value = centre[-1];
+        if (position.col < (int32_t)(matrix.width - 1))
+            right_value = centre[1];
         if (position.row > 0)
-            up_value = matrix.addr[(position.row - 1) * matrix.width + position.col];
-        if (position.row < (matrix.height - 1))
-            down_value = matrix.addr[(position.row + 1) * matrix.width + position.col];
+            up_value = *(centre - matrix.stride);
+        if (position.row < (int32_t)(matrix.height - 1))
+            down_value = *(centre + matrix.stride);
 
         // compare to neighbors
-        if (matrix.width > 1 && matrix.height > 1)
+        if (left_value > centre_value)    // check left first
         {
-            if (left_value > centre_value)    // check left first
-            {
-                printf(" -> ");
-                position.col--;
-            }
-            else if (right_value > centre_value)    // then check right
-            {
-                printf(" -> ");
-                position.col++;
-            }
-            else if (up_value > centre_value)    // then check up
-            {
-                printf(" -> ");
-                position.row--;
-            }
-            else if (down_value > centre_value)    // then check down
-            {
-                printf(" -> ");
-                position.row++;
-            }
-            else    // midpoint is the peak
-            {
-                printf("\n");
-                return matrix.addr[position.row * matrix.width + position.col];
-            }
+            position.col--;
         }
-        else
+        else if (right_value > centre_value)    // then check right
         {
-            return NOT_FOUND;
+            position.col++;
+        }
+        else if (up_value > centre_value)    // then check up
+        {
+            position.row--;
+        }
+        else if (down_value > centre_value)    // then check down
+        {
+            position.row++;
+        }
+        else    // current position is the peak
+        {
+            return centre_value;
         }
     }
 
@@ -220,66 +151,27 @@ uint32_t find2DPeakGreedyAscent(matrix_t matrix)
 
 uint32_t find2DPeakDivideConquer(matrix_t matrix)
 {
-    printMatrix(matrix);
-
-    uint32_t peak      = INVALID;
-    point2d_t position = {matrix.height / 2, matrix.width / 2};
-
-    position.row = findMatrixColumnMax(matrix, position.col);
-    printf("max in column %d is %d\n", position.row, matrix.addr[position.row * matrix.width + position.col]);
-
-    uint32_t centre_value = matrix.addr[position.row * matrix.width + position.col];
-    uint32_t left_value, right_value;
-
-    // check for edges
-    left_value = right_value = INVALID;
-    if (position.col > 0)
-        left_value = matrix.addr[position.row * matrix.width + (position.col - 1)];
-    if (position.col < (matrix.width - 1))
-        right_value = matrix.addr[position.row * matrix.width + (position.col + 1)];
-
-    // compare to neighbors
-    if (left_value > centre_value)    // check left first
-    {
-        position.col = 0;
-    }
-    else if (right_value > centre_value)    // then check right
+    point2d_t position = find2DPeakColumnHalving(matrix.addr, matrix.width, matrix.height, matrix.stride);
+    if (position.row == NOT_FOUND)
     {
-        position.col = (matrix.width / 2) - 1;
-    }
-    else
-    {
-        return centre_value;
-    }
-
-    // search peak in new subarray
-    matrix_t new_matrix = {0, (matrix.width / 2) + 1, matrix.height};
-    new_matrix.addr     = (uint8_t *)malloc(new_matrix.width * new_matrix.height);
-    for (size_t row = 0; row < new_matrix.height; row++)
-    {
-        for (size_t col = 0; col < new_matrix.width; col++)
-        {
-            new_matrix.addr[row * new_matrix.width + col] = matrix.addr[row * matrix.width + (col + position.col)];
-        }
+        return NOT_FOUND;
     }
 
-    peak = find2DPeakDivideConquer(new_matrix);
-
-    free(new_matrix.addr);
-
-    return peak;
+    return matrix.addr[position.row * matrix.stride + position.col];
 }
 
-uint32_t findMatrixColumnMax(matrix_t matrix, uint32_t col)
+uint32_t find2DPeakWindowHalving(matrix_t matrix)
 {
-    uint32_t column_max_row = 0;
-    for (int32_t i = 1; i < matrix.height; i++)
+    point2d_t position = find2DPeakPosition(matrix);
+    if (position.row == NOT_FOUND)
     {
-        if (matrix.addr[i * matrix.width + col] > matrix.addr[column_max_row * matrix.width + col])
-        {
-            column_max_row = i;
-        }
+        return NOT_FOUND;
     }
 
-    return column_max_row;
-}
\ No newline at end of file
+    return matrix.addr[position.row * matrix.stride + position.col];
+}
+
+point2d_t find2DPeakPosition(matrix_t matrix)
+{
+    return find2DPeakWindowHalving(matrix.addr, matrix.width, matrix.height, matrix.stride);
+}
@@ -6,6 +6,7 @@
 // ************************************************
 // INCLUDES
 // ************************************************
+#include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
 
@@ -33,6 +34,7 @@ typedef struct
     uint8_t *addr;
     size_t width;
     size_t height;
+    size_t stride;    // elements between row starts, >= width
 } matrix_t;
 
 typedef enum
@@ -56,4 +58,179 @@ uint32_t find1DPeakDivideConquer(array_t array);
 void fillMatrix(matrix_t array);
 void printMatrix(matrix_t array);
 uint32_t find2DPeakGreedyAscent(matrix_t matrix);
-uint32_t find2DPeakDivideConquer(matrix_t matrix);
\ No newline at end of file
+uint32_t find2DPeakDivideConquer(matrix_t matrix);
+uint32_t find2DPeakWindowHalving(matrix_t matrix);
+point2d_t find2DPeakPosition(matrix_t matrix);
+
+// iterative, allocation free, over any element type with operator<, rows are stride elements apart
+template <typename T>
+size_t find1DPeakIndex(const T *values, size_t size);
+template <typename T>
+point2d_t find2DPeakColumnHalving(const T *addr, size_t width, size_t height, size_t stride);
+template <typename T>
+point2d_t find2DPeakWindowHalving(const T *addr, size_t width, size_t height, size_t stride);
+
+// ************************************************
+// FUNCTION DEFINITIONS
+// ************************************************
+// binary search on the slope, O(log n)
+template <typename T>
+size_t find1DPeakIndex(const T *values, size_t size)
+{
+    if (size == 0)
+        return (size_t)NOT_FOUND;
+
+    size_t start = 0,
+           end   = size - 1;
+    while (start < end)
+    {
+        size_t midpoint = (start + end) / 2;
+        if (values[midpoint] < values[midpoint + 1])
+            start = midpoint + 1;
+        else
+            end = midpoint;
+    }
+
+    return start;
+}
+
+template <typename T>
+size_t findColumnMaxRow(const T *addr, size_t row_begin, size_t row_end, size_t stride, size_t col)
+{
+    size_t max_row = row_begin;
+    for (size_t row = row_begin + 1; row <= row_end; row++)
+    {
+        if (addr[max_row * stride + col] < addr[row * stride + col])
+            max_row = row;
+    }
+
+    return max_row;
+}
+
+// column max of the middle column, then keep the half with the larger neighbour, O(n log m)
+template <typename T>
+point2d_t find2DPeakColumnHalving(const T *addr, size_t width, size_t height, size_t stride)
+{
+    point2d_t position = {NOT_FOUND, NOT_FOUND};
+    if ((width == 0) || (height == 0))
+        return position;
+
+    size_t col_begin = 0,
+           col_end   = width - 1;
+    while (true)
+    {
+        size_t col      = (col_begin + col_end) / 2;
+        size_t row      = findColumnMaxRow(addr, 0, height - 1, stride, col);
+        const T *centre = &addr[row * stride + col];
+
+        if ((col > col_begin) && (*centre < centre[-1]))
+        {
+            col_end = col - 1;
+        }
+        else if ((col < col_end) && (*centre < centre[1]))
+        {
+            col_begin = col + 1;
+        }
+        else
+        {
+            position.row = (int32_t)row;
+            position.col = (int32_t)col;
+            return position;
+        }
+    }
+}
+
+// O(n + m): scan the frame and the middle cross of a window. The best cell seen so far is
+// larger than every cell on the current window's frame, so an ascent from it cannot leave
+// the window and a peak lies inside. The window shrinks to the quadrant holding that cell.
+template <typename T>
+point2d_t find2DPeakWindowHalving(const T *addr, size_t width, size_t height, size_t stride)
+{
+    point2d_t position = {NOT_FOUND, NOT_FOUND};
+    if ((width == 0) || (height == 0))
+        return position;
+
+    size_t row_begin = 0, row_end = height - 1;
+    size_t col_begin = 0, col_end = width - 1;
+    size_t best_row = 0, best_col = 0;
+    bool has_best = false;
+
+    while (true)
+    {
+        size_t row_mid = (row_begin + row_end) / 2;
+        size_t col_mid = (col_begin + col_end) / 2;
+
+        // max over rows row_begin / row_mid / row_end and columns col_begin / col_mid / col_end
+        size_t max_row = row_begin, max_col = col_begin;
+        const size_t rows[3] = {row_begin, row_mid, row_end};
+        const size_t cols[3] = {col_begin, col_mid, col_end};
+        for (int i = 0; i < 3; i++)
+        {
+            const T *row_ptr = &addr[rows[i] * stride];
+            for (size_t col = col_begin; col <= col_end; col++)
+            {
+                if (addr[max_row * stride + max_col] < row_ptr[col])
+                {
+                    max_row = rows[i];
+                    max_col = col;
+                }
+            }
+            size_t row = findColumnMaxRow(addr, row_begin, row_end, stride, cols[i]);
+            if (addr[max_row * stride + max_col] < addr[row * stride + cols[i]])
+            {
+                max_row = row;
+                max_col = cols[i];
+            }
+        }
+
+        if (!has_best || !(addr[max_row * stride + max_col] < addr[best_row * stride + best_col]))
+        {
+            // the scanned max is a peak unless a neighbour is larger, that one becomes the best
+            const T *centre = &addr[max_row * stride + max_col];
+            const T *larger = centre;
+            best_row        = max_row;
+            best_col        = max_col;
+            if ((max_row > 0) && (*larger < *(centre - stride)))
+            {
+                larger   = centre - stride;
+                best_row = max_row - 1;
+                best_col = max_col;
+            }
+            if ((max_row + 1 < height) && (*larger < *(centre + stride)))
+            {
+                larger   = centre + stride;
+                best_row = max_row + 1;
+                best_col = max_col;
+            }
+            if ((max_col > 0) && (*larger < centre[-1]))
+            {
+                larger   = centre - 1;
+                best_row = max_row;
+                best_col = max_col - 1;
+            }
+            if ((max_col + 1 < width) && (*larger < centre[1]))
+            {
+                best_row = max_row;
+                best_col = max_col + 1;
+            }
+
+            if ((best_row == max_row) && (best_col == max_col))
+            {
+                position.row = (int32_t)max_row;
+                position.col = (int32_t)max_col;
+                return position;
+            }
+            has_best = true;
+        }
+
+        // the best cell is off every scanned line, keep the quadrant around it
+        if (best_row < row_mid)
+            row_end = row_mid;
+        else
+            row_begin = row_mid;
+        if (best_col < col_mid)
+            col_end = col_mid;
+        else
+            col_begin = col_mid;
+    }
+}
\ No newline at end of file
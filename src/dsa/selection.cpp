@@ -0,0 +1,169 @@
+// ************************************************
+// PRAGMAS
+// ************************************************
+#pragma once
+
+// ************************************************
+// INCLUDES
+// ************************************************
+#include "selection.h"
+#include "sorting.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ************************************************
+// MACROS
+// ************************************************
+#define SELECT_BUCKETS 256
+
+// ************************************************
+// TYPEDEF & ENUMS
+// ************************************************
+
+// ************************************************
+// FUNCTION DECLARATIONS
+// ************************************************
+static uint32_t findRankBin(const uint64_t *count, uint32_t num_bins, uint64_t *rank);
+
+// ************************************************
+// FUNCTION DEFINITIONS
+// ************************************************
+uint8_t selectNth(array_t array, size_t nth)
+{
+    assert(nth < array.size);
+    selectNth(array.addr, array.size, nth);
+
+    return array.addr[nth];
+}
+
+// lower median for even sizes
+uint8_t selectMedian(array_t array)
+{
+    return selectNth(array, (array.size - 1) / 2);
+}
+
+void selectTopK(array_t array, size_t k)
+{
+    selectTopK(array.addr, array.size, k);
+}
+
+size_t percentileRank(uint64_t size, double fraction)
+{
+    assert(size > 0);
+    if (fraction <= 0)
+        return 0;
+    if (fraction >= 1)
+        return size - 1;
+
+    return (size_t)(fraction * (size - 1));
+}
+
+// exact from one counting pass, O(n + 256) and no reordering
+uint8_t percentile8(array_t array, double fraction)
+{
+    uint64_t count[SELECT_BUCKETS] = {0};
+    countBytes(array.addr, array.size, count);
+
+    uint64_t rank = percentileRank(array.size, fraction);
+    return findRankBin(count, SELECT_BUCKETS, &rank);
+}
+
+// two counting passes, high byte first and then the low byte of keys in the chosen bucket,
+// so the state stays at 256 counters instead of 65536
+uint16_t percentile16(const uint16_t *keys, size_t size, double fraction)
+{
+    uint64_t rank                  = percentileRank(size, fraction);
+    uint64_t count[SELECT_BUCKETS] = {0};
+    for (size_t i = 0; i < size; i++)
+    {
+        count[keys[i] >> 8]++;
+    }
+    uint32_t high = findRankBin(count, SELECT_BUCKETS, &rank);
+
+    memset(count, 0, sizeof(count));
+    for (size_t i = 0; i < size; i++)
+    {
+        if ((uint32_t)(keys[i] >> 8) == high)
+            count[keys[i] & 0xFF]++;
+    }
+    uint32_t low = findRankBin(count, SELECT_BUCKETS, &rank);
+
+    return (uint16_t)((high << 8) | low);
+}
+
+void initSelectionStream(selection_stream_t *stream, uint32_t bits)
+{
+    assert((bits == SELECT_STREAM_BITS8) || (bits == SELECT_STREAM_BITS16));
+    stream->num_bins = 1u << bits;
+    stream->total    = 0;
+    stream->count    = (uint64_t *)calloc(stream->num_bins, sizeof(uint64_t));
+    if (!stream->count)
+        assert(0);
+}
+
+void freeSelectionStream(selection_stream_t *stream)
+{
+    free(stream->count);
+    stream->count = NULL;
+    stream->total = 0;
+}
+
+// chunk memory can be reused as soon as this returns
+void addStreamChunk(selection_stream_t *stream, array_t chunk)
+{
+    countBytes(chunk.addr, chunk.size, stream->count);
+    stream->total += chunk.size;
+}
+
+void addStreamKeys(selection_stream_t *stream, const uint16_t *keys, size_t size)
+{
+    assert(stream->num_bins > UINT8_MAX + 1);
+    uint64_t *count = stream->count;
+    for (size_t i = 0; i < size; i++)
+    {
+        count[keys[i]]++;
+    }
+    stream->total += size;
+}
+
+uint32_t getStreamNth(const selection_stream_t *stream, uint64_t nth)
+{
+    assert(nth < stream->total);
+    return findRankBin(stream->count, stream->num_bins, &nth);
+}
+
+uint32_t getStreamPercentile(const selection_stream_t *stream, double fraction)
+{
+    return getStreamNth(stream, percentileRank(stream->total, fraction));
+}
+
+// the k largest keys seen, largest first, returns how many were written
+size_t getStreamTopK(const selection_stream_t *stream, size_t k, uint16_t *values)
+{
+    size_t written = 0;
+    for (uint32_t bin = stream->num_bins; (bin > 0) && (written < k); bin--)
+    {
+        uint64_t total = stream->count[bin - 1];
+        for (uint64_t i = 0; (i < total) && (written < k); i++)
+        {
+            values[written++] = (uint16_t)(bin - 1);
+        }
+    }
+
+    return written;
+}
+
+// bin holding the key of the given rank, rank becomes the rank within that bin
+uint32_t findRankBin(const uint64_t *count, uint32_t num_bins, uint64_t *rank)
+{
+    for (uint32_t bin = 0; bin < num_bins; bin++)
+    {
+        if (*rank < count[bin])
+            return bin;
+        *rank -= count[bin];
+    }
+
+    assert(0);
+    return num_bins - 1;
+}
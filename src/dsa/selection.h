@@ -0,0 +1,202 @@
+// ************************************************
+// PRAGMAS
+// ************************************************
+#pragma once
+
+// ************************************************
+// INCLUDES
+// ************************************************
+#include "parallel_sort.h"
+#include "peak_finding.h"
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <algorithm>
+
+// ************************************************
+// MACROS
+// ************************************************
+#define SELECT_SMALL_SIZE    16     // insertion sort the remaining range below this
+#define SELECT_SAMPLE_MIN    600    // Floyd-Rivest narrows the pivot on a sample above this
+#define SELECT_STREAM_BITS8  8
+#define SELECT_STREAM_BITS16 16
+
+// ************************************************
+// TYPEDEF & ENUMS
+// ************************************************
+// histogram of every key seen so far, chunks are counted and dropped
+typedef struct
+{
+    uint64_t *count;    // num_bins counters, one per key value
+    uint32_t num_bins;
+    uint64_t total;
+} selection_stream_t;
+
+// ************************************************
+// FUNCTION DECLARATIONS
+// ************************************************
+// keys[nth] becomes the key a full sort would put there, smaller ones before it, larger after
+template <typename T, typename compare_t>
+void selectNth(T *keys, size_t size, size_t nth, compare_t compare);
+template <typename T>
+void selectNth(T *keys, size_t size, size_t nth);
+// the k largest keys move to the front, largest first, the rest keep no particular order
+template <typename T, typename compare_t>
+void selectTopK(T *keys, size_t size, size_t k, compare_t compare);
+template <typename T>
+void selectTopK(T *keys, size_t size, size_t k);
+
+uint8_t selectNth(array_t array, size_t nth);
+uint8_t selectMedian(array_t array);
+void selectTopK(array_t array, size_t k);
+
+// fraction in [0, 1], the key at rank floor(fraction * (size - 1)) of the sorted order, input untouched
+size_t percentileRank(uint64_t size, double fraction);
+uint8_t percentile8(array_t array, double fraction);
+uint16_t percentile16(const uint16_t *keys, size_t size, double fraction);
+
+void initSelectionStream(selection_stream_t *stream, uint32_t bits);
+void freeSelectionStream(selection_stream_t *stream);
+void addStreamChunk(selection_stream_t *stream, array_t chunk);
+void addStreamKeys(selection_stream_t *stream, const uint16_t *keys, size_t size);
+uint32_t getStreamNth(const selection_stream_t *stream, uint64_t nth);
+uint32_t getStreamPercentile(const selection_stream_t *stream, double fraction);
+size_t getStreamTopK(const selection_stream_t *stream, size_t k, uint16_t *values);
+
+// ************************************************
+// FUNCTION DEFINITIONS
+// ************************************************
+// bounded max-heap over the first nth + 1 keys, the worst case fallback of floydRivestSelect
+template <typename T, typename compare_t>
+void heapSelect(T *keys, size_t size, size_t nth, compare_t compare)
+{
+    size_t heap_size = nth + 1;
+    for (size_t root = heap_size / 2; root > 0; root--)
+    {
+        siftDown(keys, root - 1, heap_size, compare);
+    }
+    for (size_t i = heap_size; i < size; i++)
+    {
+        if (compare(keys[i], keys[0]))
+        {
+            std::swap(keys[i], keys[0]);
+            siftDown(keys, 0, heap_size, compare);
+        }
+    }
+    std::swap(keys[0], keys[nth]);
+}
+
+template <typename T, typename compare_t>
+void floydRivestSelect(T *keys, ptrdiff_t left, ptrdiff_t right, ptrdiff_t nth, size_t depth, compare_t compare)
+{
+    while (right - left > SELECT_SMALL_SIZE)
+    {
+        // a run of bad pivots, the heap keeps the worst case at n log n
+        if (depth == 0)
+        {
+            heapSelect(keys + left, right - left + 1, nth - left, compare);
+            return;
+        }
+        depth--;
+
+        // select within a sample around the expected position first, its result is a pivot
+        // that leaves nth in a small part with high probability
+        if (right - left > SELECT_SAMPLE_MIN)
+        {
+            double n               = (double)(right - left + 1);
+            double i               = (double)(nth - left + 1);
+            double z               = log(n);
+            double s               = 0.5 * exp(2 * z / 3);
+            double sd              = 0.5 * sqrt(z * s * (n - s) / n) * ((i < n / 2) ? -1 : 1);
+            ptrdiff_t sample_left  = std::max(left, (ptrdiff_t)floor(nth - i * s / n + sd));
+            ptrdiff_t sample_right = std::min(right, (ptrdiff_t)floor(nth + (n - i) * s / n + sd));
+            floydRivestSelect(keys, sample_left, sample_right, nth, depth, compare);
+        }
+
+        // partition around keys[nth], the pivot parked at left and a sentinel at right
+        T pivot     = keys[nth];
+        ptrdiff_t i = left;
+        ptrdiff_t j = right;
+        std::swap(keys[left], keys[nth]);
+        if (compare(pivot, keys[right]))
+            std::swap(keys[right], keys[left]);
+        while (i < j)
+        {
+            std::swap(keys[i], keys[j]);
+            i++;
+            j--;
+            while (compare(keys[i], pivot))
+                i++;
+            while (compare(pivot, keys[j]))
+                j--;
+        }
+        if (!compare(keys[left], pivot) && !compare(pivot, keys[left]))
+        {
+            std::swap(keys[left], keys[j]);
+        }
+        else
+        {
+            j++;
+            std::swap(keys[j], keys[right]);
+        }
+
+        // the pivot is final at j, continue on the side holding nth
+        if (j <= nth)
+            left = j + 1;
+        if (nth <= j)
+            right = j - 1;
+    }
+    if (right > left)
+        insertionSortRange(keys + left, right - left + 1, compare);
+}
+
+template <typename T, typename compare_t>
+void selectNth(T *keys, size_t size, size_t nth, compare_t compare)
+{
+    if (nth >= size)
+        return;
+
+    size_t depth = 8;
+    for (size_t n = size; n > 1; n >>= 1)
+    {
+        depth += 2;
+    }
+    floydRivestSelect(keys, 0, (ptrdiff_t)size - 1, (ptrdiff_t)nth, depth, compare);
+}
+
+template <typename T>
+void selectNth(T *keys, size_t size, size_t nth)
+{
+    selectNth(keys, size, nth, std::less<T>());
+}
+
+template <typename T, typename compare_t>
+void selectTopK(T *keys, size_t size, size_t k, compare_t compare)
+{
+    if (k > size)
+        k = size;
+    if (k == 0)
+        return;
+
+    // min-heap of the k largest so far in the front of the array, O(n log k) and no buffer
+    auto reverse = [&compare](const T &a, const T &b) { return compare(b, a); };
+    for (size_t root = k / 2; root > 0; root--)
+    {
+        siftDown(keys, root - 1, k, reverse);
+    }
+    for (size_t i = k; i < size; i++)
+    {
+        if (compare(keys[0], keys[i]))
+        {
+            std::swap(keys[i], keys[0]);
+            siftDown(keys, 0, k, reverse);
+        }
+    }
+    heapSort(keys, k, reverse);
+}
+
+template <typename T>
+void selectTopK(T *keys, size_t size, size_t k)
+{
+    selectTopK(keys, size, k, std::less<T>());
+}
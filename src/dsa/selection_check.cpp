@@ -0,0 +1,207 @@
+// ************************************************
+// INCLUDES
+// ************************************************
+#include "selection.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+// ************************************************
+// MACROS
+// ************************************************
+#define CHECK_CHUNK 1000    // keys per addStreamChunk call, the stream never sees the whole input
+
+// ************************************************
+// TYPEDEF & ENUMS
+// ************************************************
+
+// ************************************************
+// GLOBALS
+// ************************************************
+// sizes around the insertion sort cut-off and the Floyd-Rivest sampling threshold
+static const size_t check_sizes[] = {1, 2, 3, 15, 16, 17, 100, 599, 600, 601, 5000, 100000};
+static const double check_fractions[] = {0.0, 0.01, 0.25, 0.5, 0.9, 0.99, 1.0};
+
+static uint64_t check_seed = 54321;
+
+// ************************************************
+// FUNCTION DECLARATIONS
+// ************************************************
+static uint64_t checkRandom(void);
+template <typename T>
+static std::vector<T> randomKeys(size_t size, uint64_t range);
+static bool checkSelectNth(size_t size, uint64_t range);
+static bool checkTopK(size_t size, uint64_t range);
+static bool checkPercentiles(size_t size, uint64_t range);
+static bool checkStreams(size_t size, uint64_t range);
+static bool report(const char *name, size_t size, bool same);
+
+// ************************************************
+// FUNCTION DEFINITIONS
+// ************************************************
+// ./selection_check_exe, non-zero exit when any selection differs from a full sort
+int main()
+{
+    bool ok = true;
+    for (size_t s = 0; s < sizeof(check_sizes) / sizeof(check_sizes[0]); s++)
+    {
+        size_t size = check_sizes[s];
+        for (uint64_t range = 2; range <= (1ULL << 16); range <<= 7)
+        {
+            ok &= checkSelectNth(size, range);
+            ok &= checkTopK(size, range);
+            ok &= checkPercentiles(size, range);
+            ok &= checkStreams(size, range);
+        }
+    }
+
+    printf("selection_check: %s\n", ok ? "ok" : "FAILED");
+
+    return ok ? 0 : 1;
+}
+
+uint64_t checkRandom(void)
+{
+    // xorshift64, the same sequence on every platform
+    check_seed ^= check_seed << 13;
+    check_seed ^= check_seed >> 7;
+    check_seed ^= check_seed << 17;
+
+    return check_seed;
+}
+
+template <typename T>
+std::vector<T> randomKeys(size_t size, uint64_t range)
+{
+    std::vector<T> keys(size);
+    for (size_t i = 0; i < size; i++)
+    {
+        keys[i] = (T)(checkRandom() % range);
+    }
+
+    return keys;
+}
+
+bool checkSelectNth(size_t size, uint64_t range)
+{
+    // first, last, middle and a random rank; the partition around nth must hold as well
+    std::vector<uint32_t> sorted = randomKeys<uint32_t>(size, range);
+    std::vector<uint32_t> input  = sorted;
+    std::sort(sorted.begin(), sorted.end());
+
+    size_t ranks[] = {0, size - 1, size / 2, (size_t)(checkRandom() % size)};
+    bool same      = true;
+    for (size_t r = 0; r < sizeof(ranks) / sizeof(ranks[0]); r++)
+    {
+        std::vector<uint32_t> keys = input;
+        size_t nth                 = ranks[r];
+        selectNth(keys.data(), size, nth);
+        same &= (keys[nth] == sorted[nth]);
+        for (size_t i = 0; same && i < size; i++)
+        {
+            same = (i < nth) ? (keys[i] <= keys[nth]) : (keys[i] >= keys[nth]);
+        }
+    }
+    bool ok = report("selectNth", size, same);
+
+    std::vector<uint8_t> bytes  = randomKeys<uint8_t>(size, std::min<uint64_t>(range, 256));
+    std::vector<uint8_t> expect = bytes;
+    std::sort(expect.begin(), expect.end());
+    array_t array = {bytes.data(), size};
+
+    return report("selectMedian", size, selectMedian(array) == expect[(size - 1) / 2]) && ok;
+}
+
+bool checkTopK(size_t size, uint64_t range)
+{
+    // the front k keys are the k largest, largest first
+    std::vector<uint64_t> keys     = randomKeys<uint64_t>(size, range);
+    std::vector<uint64_t> expected = keys;
+    std::sort(expected.begin(), expected.end(), std::greater<uint64_t>());
+
+    size_t k = std::min<size_t>(size, 1 + checkRandom() % 50);
+    selectTopK(keys.data(), size, k);
+
+    return report("selectTopK", size, std::equal(keys.begin(), keys.begin() + k, expected.begin()));
+}
+
+bool checkPercentiles(size_t size, uint64_t range)
+{
+    std::vector<uint8_t> bytes   = randomKeys<uint8_t>(size, std::min<uint64_t>(range, 256));
+    std::vector<uint16_t> words  = randomKeys<uint16_t>(size, range);
+    std::vector<uint8_t> bytes0  = bytes;
+    std::vector<uint16_t> words0 = words;
+    std::vector<uint8_t> sorted8(bytes);
+    std::vector<uint16_t> sorted16(words);
+    std::sort(sorted8.begin(), sorted8.end());
+    std::sort(sorted16.begin(), sorted16.end());
+
+    // input must come back untouched
+    bool same     = true;
+    array_t array = {bytes.data(), size};
+    for (size_t f = 0; f < sizeof(check_fractions) / sizeof(check_fractions[0]); f++)
+    {
+        size_t rank = percentileRank(size, check_fractions[f]);
+        same &= (percentile8(array, check_fractions[f]) == sorted8[rank]);
+        same &= (percentile16(words.data(), size, check_fractions[f]) == sorted16[rank]);
+    }
+    same &= (bytes == bytes0) && (words == words0);
+
+    return report("percentile8 / percentile16", size, same);
+}
+
+bool checkStreams(size_t size, uint64_t range)
+{
+    // the same keys as chunks of bytes and as 16-bit keys, compared with the sorted whole
+    std::vector<uint8_t> bytes  = randomKeys<uint8_t>(size, std::min<uint64_t>(range, 256));
+    std::vector<uint16_t> words = randomKeys<uint16_t>(size, range);
+
+    selection_stream_t stream8, stream16;
+    initSelectionStream(&stream8, SELECT_STREAM_BITS8);
+    initSelectionStream(&stream16, SELECT_STREAM_BITS16);
+    for (size_t begin = 0; begin < size; begin += CHECK_CHUNK)
+    {
+        size_t count  = std::min<size_t>(CHECK_CHUNK, size - begin);
+        array_t chunk = {&bytes[begin], count};
+        addStreamChunk(&stream8, chunk);
+        addStreamKeys(&stream16, &words[begin], count);
+    }
+    std::sort(bytes.begin(), bytes.end());
+    std::sort(words.begin(), words.end());
+
+    bool same = (stream8.total == size) && (stream16.total == size);
+    for (size_t f = 0; f < sizeof(check_fractions) / sizeof(check_fractions[0]); f++)
+    {
+        size_t rank = percentileRank(size, check_fractions[f]);
+        same &= (getStreamPercentile(&stream8, check_fractions[f]) == bytes[rank]);
+        same &= (getStreamPercentile(&stream16, check_fractions[f]) == words[rank]);
+    }
+    size_t nth = (size_t)(checkRandom() % size);
+    same &= (getStreamNth(&stream16, nth) == words[nth]);
+
+    // more than the stream holds returns every key
+    size_t k = std::min<size_t>(size + 1, 64);
+    std::vector<uint16_t> top(k);
+    size_t written = getStreamTopK(&stream16, k, top.data());
+    same &= (written == std::min(k, size));
+    for (size_t i = 0; same && i < written; i++)
+    {
+        same = (top[i] == words[size - 1 - i]);
+    }
+
+    freeSelectionStream(&stream8);
+    freeSelectionStream(&stream16);
+
+    return report("selection stream", size, same);
+}
+
+bool report(const char *name, size_t size, bool same)
+{
+    if (!same)
+        fprintf(stderr, "%s differs from the sorted keys at size %zu\n", name, size);
+
+    return same;
+}
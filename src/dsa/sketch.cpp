@@ -0,0 +1,378 @@
+// ************************************************
+// PRAGMAS
+// ************************************************
+#pragma once
+
+// ************************************************
+// INCLUDES
+// ************************************************
+#include "sketch.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef _MSC_VER
+    #include <intrin.h>
+#endif
+
+// ************************************************
+// MACROS
+// ************************************************
+#define LSH_MIN_ENTRIES 1024
+#define MIX_MULTIPLIER  0xBF58476D1CE4E5B9ULL
+
+// ************************************************
+// TYPEDEF & ENUMS
+// ************************************************
+
+// ************************************************
+// FUNCTION DECLARATIONS
+// ************************************************
+static uint64_t mixHash(uint64_t hash);
+static uint64_t bandKey(const document_sketch_t *sketch, size_t band, size_t rows_per_band);
+static int compareEntries(const void *lhs, const void *rhs);
+static int compareDocs(const void *lhs, const void *rhs);
+static bool isEmptySketch(const document_sketch_t *sketch);
+static size_t lowerBound(const lsh_index_t *index, uint64_t key);
+
+// ************************************************
+// FUNCTION DEFINITIONS
+// ************************************************
+void computeSketch(tokenizer_t *tokenizer, document_sketch_t *sketch)
+{
+    // one pass over the tokens: k minhash permutations are derived from one 64-bit token
+    // hash as h1 + i * h2, simhash votes every bit of a second mix of the same hash
+    int32_t votes[SKETCH_SIMHASH_BITS] = {0};
+    for (size_t i = 0; i < SKETCH_NUM_HASHES; i++)
+    {
+        sketch->minhash[i] = UINT32_MAX;
+    }
+
+    size_t max_fold = 256;
+    char *fold      = (char *)malloc(max_fold);
+    if (!fold)
+        assert(0);
+
+    token_t token;
+    while (nextToken(tokenizer, &token))
+    {
+        uint64_t hash;
+        if (tokenizer->fold_case)
+        {
+            if (token.length > max_fold)
+            {
+                while (token.length > max_fold)
+                {
+                    max_fold *= 2;
+                }
+                fold = (char *)realloc(fold, max_fold);
+                if (!fold)
+                    assert(0);
+            }
+            foldTokenCase(&token, fold);
+            hash = hashWord(fold, token.length);
+        }
+        else
+        {
+            hash = hashWord(token.ptr, token.length);
+        }
+
+        uint32_t h1 = (uint32_t)hash;
+        uint32_t h2 = (uint32_t)(hash >> 32) | 1;
+        for (uint32_t i = 0; i < SKETCH_NUM_HASHES; i++)
+        {
+            uint32_t permuted  = h1 + i * h2;
+            sketch->minhash[i] = (permuted < sketch->minhash[i]) ? permuted : sketch->minhash[i];
+        }
+
+        uint64_t bits = mixHash(hash);
+        for (uint32_t bit = 0; bit < SKETCH_SIMHASH_BITS; bit++)
+        {
+            votes[bit] += ((bits >> bit) & 1) ? 1 : -1;
+        }
+    }
+    free(fold);
+
+    sketch->simhash = 0;
+    for (uint32_t bit = 0; bit < SKETCH_SIMHASH_BITS; bit++)
+    {
+        if (votes[bit] > 0)
+        {
+            sketch->simhash |= 1ULL << bit;
+        }
+    }
+}
+
+double estimateJaccard(const document_sketch_t *sketch1, const document_sketch_t *sketch2)
+{
+    uint32_t equal = 0;
+    for (size_t i = 0; i < SKETCH_NUM_HASHES; i++)
+    {
+        equal += (sketch1->minhash[i] == sketch2->minhash[i]);
+    }
+
+    return equal / (double)SKETCH_NUM_HASHES;
+}
+
+uint32_t simhashDistance(const document_sketch_t *sketch1, const document_sketch_t *sketch2)
+{
+    uint64_t diff = sketch1->simhash ^ sketch2->simhash;
+#ifdef _MSC_VER
+    return (uint32_t)__popcnt64(diff);
+#else
+    return (uint32_t)__builtin_popcountll(diff);
+#endif
+}
+
+void initLshIndex(lsh_index_t *index, size_t num_bands)
+{
+    assert(num_bands > 0 && SKETCH_NUM_HASHES % num_bands == 0);
+
+    index->num_bands     = num_bands;
+    index->rows_per_band = SKETCH_NUM_HASHES / num_bands;
+    index->num_docs      = 0;
+    index->num_entries   = 0;
+    index->max_entries   = LSH_MIN_ENTRIES;
+    index->entries       = (lsh_entry_t *)malloc(index->max_entries * sizeof(lsh_entry_t));
+    index->finalized     = false;
+    if (!index->entries)
+        assert(0);
+}
+
+void freeLshIndex(lsh_index_t *index)
+{
+    free(index->entries);
+    memset(index, 0, sizeof(*index));
+}
+
+uint32_t addLshDocument(lsh_index_t *index, const document_sketch_t *sketch)
+{
+    assert(!index->finalized);
+
+    while (index->num_entries + index->num_bands > index->max_entries)
+    {
+        index->max_entries *= 2;
+        index->entries = (lsh_entry_t *)realloc(index->entries, index->max_entries * sizeof(lsh_entry_t));
+        if (!index->entries)
+            assert(0);
+    }
+
+    uint32_t doc = (uint32_t)index->num_docs++;
+    for (size_t band = 0; band < index->num_bands; band++)
+    {
+        lsh_entry_t *entry = &index->entries[index->num_entries++];
+        entry->key         = bandKey(sketch, band, index->rows_per_band);
+        entry->doc         = doc;
+    }
+
+    return doc;
+}
+
+void finalizeLshIndex(lsh_index_t *index)
+{
+    qsort(index->entries, index->num_entries, sizeof(lsh_entry_t), compareEntries);
+    index->finalized = true;
+}
+
+size_t queryLshCandidates(const lsh_index_t *index, const document_sketch_t *sketch, uint32_t *candidates,
+                          size_t max_candidates)
+{
+    // num_bands binary searches, cost grows with log(docs) + bucket sizes rather than docs
+    assert(index->finalized);
+
+    size_t num_candidates = 0;
+    for (size_t band = 0; band < index->num_bands; band++)
+    {
+        uint64_t key = bandKey(sketch, band, index->rows_per_band);
+        for (size_t i = lowerBound(index, key); i < index->num_entries && index->entries[i].key == key; i++)
+        {
+            if (num_candidates == max_candidates)
+                break;
+            candidates[num_candidates++] = index->entries[i].doc;
+        }
+    }
+
+    // a doc can match in several bands
+    qsort(candidates, num_candidates, sizeof(uint32_t), compareDocs);
+    size_t unique = 0;
+    for (size_t i = 0; i < num_candidates; i++)
+    {
+        if (unique == 0 || candidates[unique - 1] != candidates[i])
+            candidates[unique++] = candidates[i];
+    }
+
+    return unique;
+}
+
+size_t findLshCandidatePairs(const lsh_index_t *index, const document_sketch_t *sketches, doc_pair_t **pairs)
+{
+    // every run of equal keys is a bucket, all docs in a bucket are candidates of each other. pairs
+    // are gathered per doc1 over its own buckets and deduplicated there, so a pair colliding in
+    // many bands is stored once; a doc only pairs with the next LSH_MAX_BUCKET docs of a bucket
+    assert(index->finalized);
+
+    size_t num_docs   = index->num_docs;
+    size_t num_bands  = index->num_bands;
+    size_t num_pairs  = 0;
+    size_t max_pairs  = LSH_MIN_ENTRIES;
+    doc_pair_t *found = (doc_pair_t *)malloc(max_pairs * sizeof(doc_pair_t));
+    if (!found)
+        assert(0);
+
+    // positions of each doc's entries, num_bands per doc
+    size_t *positions = (size_t *)malloc((index->num_entries + 1) * sizeof(size_t));
+    uint32_t *filled  = (uint32_t *)calloc(num_docs + 1, sizeof(uint32_t));
+    if (!positions || !filled)
+        assert(0);
+    for (size_t i = 0; i < index->num_entries; i++)
+    {
+        uint32_t doc                               = index->entries[i].doc;
+        positions[doc * num_bands + filled[doc]++] = i;
+    }
+
+    // seen[doc] == doc1 + 1 once doc is a candidate of doc1; docs without tokens share every
+    // band key and would all pair up, they are marked UINT32_MAX and never paired
+    uint32_t *seen       = filled;
+    uint32_t *candidates = (uint32_t *)malloc((num_bands * LSH_MAX_BUCKET + 1) * sizeof(uint32_t));
+    if (!candidates)
+        assert(0);
+    for (size_t doc = 0; doc < num_docs; doc++)
+    {
+        seen[doc] = isEmptySketch(&sketches[doc]) ? UINT32_MAX : 0;
+    }
+
+    for (uint32_t doc1 = 0; doc1 < num_docs; doc1++)
+    {
+        if (seen[doc1] == UINT32_MAX)
+            continue;
+
+        size_t num_candidates = 0;
+        for (size_t band = 0; band < num_bands; band++)
+        {
+            // entries are sorted by doc within a key, everything after doc1 in its bucket is a doc2 > doc1
+            size_t begin = positions[doc1 * num_bands + band];
+            size_t end   = begin + 1;
+            while (end < index->num_entries && end <= begin + LSH_MAX_BUCKET &&
+                   index->entries[end].key == index->entries[begin].key)
+            {
+                uint32_t doc2 = index->entries[end++].doc;
+                if (seen[doc2] == UINT32_MAX || seen[doc2] == doc1 + 1)
+                    continue;
+
+                seen[doc2]                   = doc1 + 1;
+                candidates[num_candidates++] = doc2;
+            }
+        }
+
+        while (num_pairs + num_candidates > max_pairs)
+        {
+            max_pairs *= 2;
+            found = (doc_pair_t *)realloc(found, max_pairs * sizeof(doc_pair_t));
+            if (!found)
+                assert(0);
+        }
+
+        // attach the estimated similarity, pairs come out sorted by doc1 then doc2
+        qsort(candidates, num_candidates, sizeof(uint32_t), compareDocs);
+        for (size_t i = 0; i < num_candidates; i++)
+        {
+            doc_pair_t *pair = &found[num_pairs++];
+            pair->doc1       = doc1;
+            pair->doc2       = candidates[i];
+            pair->score      = estimateJaccard(&sketches[doc1], &sketches[candidates[i]]);
+        }
+    }
+    free(candidates);
+    free(filled);
+    free(positions);
+
+    *pairs = found;
+
+    return num_pairs;
+}
+
+size_t confirmCandidatePairs(doc_pair_t *pairs, size_t num_pairs, const sparse_vector_t *vectors, double max_distance)
+{
+    // exact angle only for candidates, keeps pairs within max_distance with score = cosine similarity
+    size_t kept = 0;
+    for (size_t i = 0; i < num_pairs; i++)
+    {
+        const sparse_vector_t *vector1 = &vectors[pairs[i].doc1];
+        const sparse_vector_t *vector2 = &vectors[pairs[i].doc2];
+        if (computeDocumentDistance(vector1, vector2) <= max_distance)
+        {
+            pairs[kept]       = pairs[i];
+            pairs[kept].score = computeCosineSimilarity(vector1, vector2);
+            kept++;
+        }
+    }
+
+    return kept;
+}
+
+uint64_t mixHash(uint64_t hash)
+{
+    hash ^= hash >> 30;
+    hash *= MIX_MULTIPLIER;
+    hash ^= hash >> 27;
+    hash *= 0x94D049BB133111EBULL;
+    hash ^= hash >> 31;
+
+    return hash;
+}
+
+uint64_t bandKey(const document_sketch_t *sketch, size_t band, size_t rows_per_band)
+{
+    uint64_t key = mixHash(band + 1);
+    for (size_t row = 0; row < rows_per_band; row++)
+    {
+        key = mixHash(key ^ sketch->minhash[band * rows_per_band + row]);
+    }
+
+    return key;
+}
+
+int compareEntries(const void *lhs, const void *rhs)
+{
+    const lsh_entry_t *entry1 = (const lsh_entry_t *)lhs;
+    const lsh_entry_t *entry2 = (const lsh_entry_t *)rhs;
+    if (entry1->key != entry2->key)
+        return (entry1->key < entry2->key) ? -1 : 1;
+    if (entry1->doc != entry2->doc)
+        return (entry1->doc < entry2->doc) ? -1 : 1;
+
+    return 0;
+}
+
+int compareDocs(const void *lhs, const void *rhs)
+{
+    uint32_t doc1 = *(const uint32_t *)lhs;
+    uint32_t doc2 = *(const uint32_t *)rhs;
+
+    return (doc1 > doc2) - (doc1 < doc2);
+}
+
+bool isEmptySketch(const document_sketch_t *sketch)
+{
+    for (size_t i = 0; i < SKETCH_NUM_HASHES; i++)
+    {
+        if (sketch->minhash[i] != UINT32_MAX)
+            return false;
+    }
+
+    return true;
+}
+
+size_t lowerBound(const lsh_index_t *index, uint64_t key)
+{
+    size_t lo = 0, hi = index->num_entries;
+    while (lo < hi)
+    {
+        size_t mid = (lo + hi) / 2;
+        if (index->entries[mid].key < key)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    return lo;
+}
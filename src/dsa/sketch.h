@@ -0,0 +1,65 @@
+// ************************************************
+// PRAGMAS
+// ************************************************
+#pragma once
+
+// ************************************************
+// INCLUDES
+// ************************************************
+#include <stddef.h>
+#include <stdint.h>
+
+#include "corpus_index.h"
+#include "document_distance.h"
+#include "tokenizer.h"
+
+// ************************************************
+// MACROS
+// ************************************************
+#define SKETCH_NUM_HASHES   128
+#define SKETCH_SIMHASH_BITS 64
+#define LSH_DEFAULT_BANDS   32    // 32 bands x 4 rows, pairs above ~0.4 Jaccard collide in some band
+#define LSH_MAX_BUCKET      256   // docs a doc pairs with per bucket, bounds pairs on boilerplate-heavy corpora
+
+// ************************************************
+// TYPEDEF & ENUMS
+// ************************************************
+// fixed size summary of a document regardless of its length
+typedef struct
+{
+    uint32_t minhash[SKETCH_NUM_HASHES];
+    uint64_t simhash;
+} document_sketch_t;
+
+typedef struct
+{
+    uint64_t key;    // hash of one band of a sketch, band number included
+    uint32_t doc;
+} lsh_entry_t;
+
+typedef struct
+{
+    size_t num_bands;
+    size_t rows_per_band;
+    size_t num_docs;
+    size_t num_entries;
+    size_t max_entries;
+    lsh_entry_t *entries;    // sorted by key once finalized
+    bool finalized;
+} lsh_index_t;
+
+// ************************************************
+// FUNCTION DECLARATIONS
+// ************************************************
+void computeSketch(tokenizer_t *tokenizer, document_sketch_t *sketch);
+double estimateJaccard(const document_sketch_t *sketch1, const document_sketch_t *sketch2);
+uint32_t simhashDistance(const document_sketch_t *sketch1, const document_sketch_t *sketch2);
+
+void initLshIndex(lsh_index_t *index, size_t num_bands);
+void freeLshIndex(lsh_index_t *index);
+uint32_t addLshDocument(lsh_index_t *index, const document_sketch_t *sketch);
+void finalizeLshIndex(lsh_index_t *index);
+size_t queryLshCandidates(const lsh_index_t *index, const document_sketch_t *sketch, uint32_t *candidates,
+                          size_t max_candidates);
+size_t findLshCandidatePairs(const lsh_index_t *index, const document_sketch_t *sketches, doc_pair_t **pairs);
+size_t confirmCandidatePairs(doc_pair_t *pairs, size_t num_pairs, const sparse_vector_t *vectors, double max_distance);
@@ -0,0 +1,178 @@
+// ************************************************
+// INCLUDES
+// ************************************************
+#include "parallel_sort.h"
+#include "sorting.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+
+// ************************************************
+// MACROS
+// ************************************************
+#define CHECK_THREADS 4
+
+// ************************************************
+// TYPEDEF & ENUMS
+// ************************************************
+// key plus its input position, a stable sort keeps positions ascending within a key
+typedef struct
+{
+    uint32_t key;
+    uint32_t position;
+} check_record_t;
+
+// ************************************************
+// GLOBALS
+// ************************************************
+// sizes around every switch between algorithms: insertion, network block, counting, radix
+static const size_t check_sizes[] = {0, 1, 2, 3, 7, 8, 9, 16, 31, 32, 33, 63, 64, 65, 100, 1000, 100000};
+
+static uint64_t check_seed = 12345;
+
+// ************************************************
+// FUNCTION DECLARATIONS
+// ************************************************
+static uint64_t checkRandom(void);
+template <typename T>
+static std::vector<T> randomKeys(size_t size, uint64_t range);
+template <typename T>
+static bool checkSortKeys(const char *name, void (*sort)(T *, size_t), size_t size, uint64_t range);
+static bool checkArraySort(const char *name, void (*sort)(array_t), size_t size, uint64_t range);
+static bool checkParallelSort(size_t size, uint64_t range, unsigned num_threads);
+static bool report(const char *name, size_t size, bool same);
+
+// ************************************************
+// FUNCTION DEFINITIONS
+// ************************************************
+// ./sort_check_exe, non-zero exit when any sort differs from std::sort / std::stable_sort
+int main()
+{
+    bool ok = true;
+    for (size_t s = 0; s < sizeof(check_sizes) / sizeof(check_sizes[0]); s++)
+    {
+        size_t size = check_sizes[s];
+        ok &= checkSortKeys<uint8_t>("sortKeys8", sortKeys, size, 1ULL << 8);
+        ok &= checkSortKeys<uint16_t>("sortKeys16", sortKeys, size, 1ULL << 16);
+        ok &= checkSortKeys<uint32_t>("sortKeys32", sortKeys, size, 1ULL << 32);
+        ok &= checkSortKeys<uint64_t>("sortKeys64", sortKeys, size, 0);
+        ok &= checkSortKeys<uint16_t>("radixSort16", radixSort, size, 1ULL << 16);
+        ok &= checkSortKeys<uint32_t>("radixSort32", radixSort, size, 1ULL << 32);
+        ok &= checkSortKeys<uint64_t>("radixSort64", radixSort, size, 0);
+        ok &= checkArraySort("countingSort", countingSort, size, 1ULL << 8);
+
+        // few distinct keys, so runs of equal keys cross every digit and bucket boundary
+        ok &= checkSortKeys<uint32_t>("sortKeys32 duplicates", sortKeys, size, 3);
+        ok &= checkSortKeys<uint64_t>("radixSort64 duplicates", radixSort, size, 3);
+
+        for (unsigned num_threads = 1; num_threads <= CHECK_THREADS; num_threads *= 2)
+        {
+            ok &= checkParallelSort(size, 1ULL << 32, num_threads);
+            ok &= checkParallelSort(size, 5, num_threads);
+        }
+    }
+
+    // a single padded block of the sorting network, every size it takes
+    for (size_t size = 0; size <= SORT_NETWORK_BLOCK; size++)
+    {
+        ok &= checkSortKeys<uint32_t>("networkSort", networkSort, size, 1ULL << 32);
+        ok &= checkSortKeys<uint32_t>("networkSort duplicates", networkSort, size, 2);
+    }
+
+    // equal keys used to stop the binary search from narrowing, keep the quadratic sorts small
+    for (size_t size = 0; size <= 300; size += 13)
+    {
+        ok &= checkArraySort("binaryInsertionSort", binaryInsertionSort, size, 1ULL << 8);
+        ok &= checkArraySort("binaryInsertionSort duplicates", binaryInsertionSort, size, 2);
+        ok &= checkArraySort("binaryInsertionSort equal", binaryInsertionSort, size, 1);
+        ok &= checkArraySort("insertionSort", insertionSort, size, 1ULL << 8);
+    }
+
+    printf("sort_check: %s\n", ok ? "ok" : "FAILED");
+
+    return ok ? 0 : 1;
+}
+
+uint64_t checkRandom(void)
+{
+    // xorshift64, the same sequence on every platform
+    check_seed ^= check_seed << 13;
+    check_seed ^= check_seed >> 7;
+    check_seed ^= check_seed << 17;
+
+    return check_seed;
+}
+
+template <typename T>
+std::vector<T> randomKeys(size_t size, uint64_t range)
+{
+    // range 0 is the whole 64-bit range
+    std::vector<T> keys(size);
+    for (size_t i = 0; i < size; i++)
+    {
+        uint64_t value = checkRandom();
+        keys[i]        = (T)(range ? value % range : value);
+    }
+
+    return keys;
+}
+
+template <typename T>
+bool checkSortKeys(const char *name, void (*sort)(T *, size_t), size_t size, uint64_t range)
+{
+    std::vector<T> keys     = randomKeys<T>(size, range);
+    std::vector<T> expected = keys;
+    std::sort(expected.begin(), expected.end());
+    sort(keys.data(), size);
+
+    return report(name, size, keys == expected);
+}
+
+bool checkArraySort(const char *name, void (*sort)(array_t), size_t size, uint64_t range)
+{
+    std::vector<uint8_t> keys     = randomKeys<uint8_t>(size, range);
+    std::vector<uint8_t> expected = keys;
+    std::sort(expected.begin(), expected.end());
+    array_t array = {keys.data(), size};
+    sort(array);
+
+    return report(name, size, keys == expected);
+}
+
+bool checkParallelSort(size_t size, uint64_t range, unsigned num_threads)
+{
+    std::vector<uint32_t> keys = randomKeys<uint32_t>(size, range);
+    std::vector<check_record_t> records(size);
+    for (size_t i = 0; i < size; i++)
+    {
+        records[i].key      = keys[i];
+        records[i].position = (uint32_t)i;
+    }
+    auto by_key = [](const check_record_t &a, const check_record_t &b) { return a.key < b.key; };
+
+    std::vector<uint32_t> expected = keys;
+    std::sort(expected.begin(), expected.end());
+    parallelSort(keys.data(), size, std::less<uint32_t>(), false, num_threads);
+    bool ok = report("parallelSort", size, keys == expected);
+
+    std::vector<check_record_t> stable = records;
+    std::stable_sort(stable.begin(), stable.end(), by_key);
+    parallelSort(records.data(), size, by_key, true, num_threads);
+    bool same = true;
+    for (size_t i = 0; same && i < size; i++)
+    {
+        same = (records[i].key == stable[i].key) && (records[i].position == stable[i].position);
+    }
+
+    return report("parallelSort stable", size, same) && ok;
+}
+
+bool report(const char *name, size_t size, bool same)
+{
+    if (!same)
+        fprintf(stderr, "%s differs from the reference sort at size %zu\n", name, size);
+
+    return same;
+}
@@ -7,12 +7,17 @@
 // INCLUDES
 // ************************************************
 #include "sorting.h"
+#include <assert.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
+#include "cpu.hpp"
 
 // ************************************************
 // MACROS
 // ************************************************
+#define RADIX_BITS    8
+#define RADIX_BUCKETS (1 << RADIX_BITS)
 
 // ************************************************
 // TYPEDEF & ENUMS
@@ -21,61 +26,241 @@
 // ************************************************
 // FUNCTION DECLARATIONS
 // ************************************************
+template <typename T>
+static void insertionSortKeys(T *keys, size_t size);
+template <typename T>
+static void radixSortKeys(T *keys, size_t size);
+// sorting_avx2.cpp, built with AVX2 enabled and only called when the cpu has it
+void networkSortBlockAvx2(uint32_t *keys);
 
 // ************************************************
 // FUNCTION DEFINITIONS
 // ************************************************
 void insertionSort(array_t array)
 {
-    for (int init_pos = 1; init_pos < array.size; ++init_pos)
-    {
-        uint32_t final_pos = init_pos;
-        while ((final_pos > 0) && (array.addr[final_pos - 1] > array.addr[final_pos]))
-        {
-            uint32_t temp             = array.addr[final_pos - 1];
-            array.addr[final_pos - 1] = array.addr[final_pos];
-            array.addr[final_pos]     = temp;
-            final_pos--;
-        }
-    }
+    insertionSortKeys(array.addr, array.size);
 
     return;
 }
 
 void binaryInsertionSort(array_t array)
 {
-    for (int init_pos = 1; init_pos < array.size; ++init_pos)
+    for (size_t init_pos = 1; init_pos < array.size; ++init_pos)
     {
-        uint32_t final_pos = init_pos;
-        uint32_t start     = 0,
-                 end       = init_pos;
+        // first position holding a larger value, so equal values keep their order
+        uint8_t value = array.addr[init_pos];
+        size_t start  = 0,
+               end    = init_pos;
         while (start < end)
         {
-            uint32_t midpoint   = (start + end) / 2;
-            uint32_t centre_val = array.addr[init_pos];
-
-            if ((array.addr[midpoint] <= centre_val) && ((array.addr[midpoint + 1] >= array.addr[init_pos])))
+            size_t midpoint = (start + end) / 2;
+            if (array.addr[midpoint] <= value)
             {
-                final_pos = midpoint + 1;
-                break;
+                start = midpoint + 1;
             }
-            else if (array.addr[midpoint] < array.addr[init_pos])
-            {
-                start = midpoint;
-            }
-            else if (array.addr[midpoint] > array.addr[init_pos])
+            else
             {
                 end = midpoint;
             }
         }
 
-        for (int i = init_pos; i > final_pos; --i)
+        memmove(&array.addr[start + 1], &array.addr[start], init_pos - start);
+        array.addr[start] = value;
+    }
+
+    return;
+}
+
+void countingSort(array_t array)
+{
+    uint64_t count[RADIX_BUCKETS] = {0};
+    countBytes(array.addr, array.size, count);
+
+    uint8_t *dst = array.addr;
+    for (int value = 0; value < RADIX_BUCKETS; value++)
+    {
+        memset(dst, value, count[value]);
+        dst += count[value];
+    }
+
+    return;
+}
+
+void countBytes(const uint8_t *keys, size_t size, uint64_t *count)
+{
+    // four histograms so consecutive equal values do not serialize on one counter
+    uint32_t sub[4][RADIX_BUCKETS];
+    while (size > 0)
+    {
+        // 32-bit counters are flushed before they can overflow
+        size_t block = (size < UINT32_MAX) ? size : UINT32_MAX;
+        memset(sub, 0, sizeof(sub));
+        size_t i = 0;
+        for (; i + 4 <= block; i += 4)
         {
-            uint32_t temp     = array.addr[i - 1];
-            array.addr[i - 1] = array.addr[i];
-            array.addr[i]     = temp;
+            sub[0][keys[i]]++;
+            sub[1][keys[i + 1]]++;
+            sub[2][keys[i + 2]]++;
+            sub[3][keys[i + 3]]++;
         }
+        for (; i < block; i++)
+        {
+            sub[0][keys[i]]++;
+        }
+        for (int value = 0; value < RADIX_BUCKETS; value++)
+        {
+            count[value] += (uint64_t)sub[0][value] + sub[1][value] + sub[2][value] + sub[3][value];
+        }
+        keys += block;
+        size -= block;
     }
+}
 
-    return;
-}
\ No newline at end of file
+void sortArray(array_t array)
+{
+    sortKeys(array.addr, array.size);
+}
+
+void sortKeys(uint8_t *keys, size_t size)
+{
+    if (size < COUNTING_SORT_MIN)
+    {
+        insertionSortKeys(keys, size);
+    }
+    else
+    {
+        array_t array = {keys, size};
+        countingSort(array);
+    }
+}
+
+void sortKeys(uint16_t *keys, size_t size)
+{
+    if (size <= SORT_SMALL_SIZE)
+        insertionSortKeys(keys, size);
+    else
+        radixSortKeys(keys, size);
+}
+
+void sortKeys(uint32_t *keys, size_t size)
+{
+    if (size <= SORT_SMALL_SIZE)
+        networkSort(keys, size);
+    else
+        radixSortKeys(keys, size);
+}
+
+void sortKeys(uint64_t *keys, size_t size)
+{
+    if (size <= SORT_SMALL_SIZE)
+        insertionSortKeys(keys, size);
+    else
+        radixSortKeys(keys, size);
+}
+
+void radixSort(uint16_t *keys, size_t size)
+{
+    radixSortKeys(keys, size);
+}
+
+void radixSort(uint32_t *keys, size_t size)
+{
+    radixSortKeys(keys, size);
+}
+
+void radixSort(uint64_t *keys, size_t size)
+{
+    radixSortKeys(keys, size);
+}
+
+void networkSort(uint32_t *keys, size_t size)
+{
+    // one padded block, larger inputs belong to radix sort
+    static const bool has_avx2 = (simd_level() >= simd_avx2);
+    if (has_avx2 && (size > 8) && (size <= SORT_NETWORK_BLOCK))
+    {
+        uint32_t block[SORT_NETWORK_BLOCK];
+        memcpy(block, keys, size * sizeof(uint32_t));
+        for (size_t i = size; i < SORT_NETWORK_BLOCK; i++)
+        {
+            block[i] = UINT32_MAX;
+        }
+        networkSortBlockAvx2(block);
+        memcpy(keys, block, size * sizeof(uint32_t));
+        return;
+    }
+    insertionSortKeys(keys, size);
+}
+
+template <typename T>
+void insertionSortKeys(T *keys, size_t size)
+{
+    // shift the larger prefix up one slot instead of swapping pairwise
+    for (size_t init_pos = 1; init_pos < size; ++init_pos)
+    {
+        T value          = keys[init_pos];
+        size_t final_pos = init_pos;
+        while ((final_pos > 0) && (keys[final_pos - 1] > value))
+        {
+            keys[final_pos] = keys[final_pos - 1];
+            final_pos--;
+        }
+        keys[final_pos] = value;
+    }
+}
+
+template <typename T>
+void radixSortKeys(T *keys, size_t size)
+{
+    if (size < 2)
+        return;
+
+    const int num_digits = sizeof(T);
+
+    // histograms of every digit in one read pass
+    size_t count[sizeof(T)][RADIX_BUCKETS] = {{0}};
+    for (size_t i = 0; i < size; i++)
+    {
+        T key = keys[i];
+        for (int digit = 0; digit < num_digits; digit++)
+        {
+            count[digit][(key >> (digit * RADIX_BITS)) & (RADIX_BUCKETS - 1)]++;
+        }
+    }
+
+    T *buffer = (T *)malloc(size * sizeof(T));
+    if (!buffer)
+        assert(0);
+
+    T *src = keys;
+    T *dst = buffer;
+    for (int digit = 0; digit < num_digits; digit++)
+    {
+        // a digit shared by every key would only copy, skip the pass
+        size_t *bucket = count[digit];
+        if (bucket[(src[0] >> (digit * RADIX_BITS)) & (RADIX_BUCKETS - 1)] == size)
+            continue;
+
+        size_t offset = 0;
+        for (int value = 0; value < RADIX_BUCKETS; value++)
+        {
+            size_t total  = bucket[value];
+            bucket[value] = offset;
+            offset += total;
+        }
+
+        for (size_t i = 0; i < size; i++)
+        {
+            T key = src[i];
+            dst[bucket[(key >> (digit * RADIX_BITS)) & (RADIX_BUCKETS - 1)]++] = key;
+        }
+
+        T *temp = src;
+        src     = dst;
+        dst     = temp;
+    }
+
+    if (src != keys)
+        memcpy(keys, src, size * sizeof(T));
+    free(buffer);
+}
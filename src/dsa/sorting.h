@@ -7,12 +7,16 @@
 // INCLUDES
 // ************************************************
 #include "peak_finding.h"
+#include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
 
 // ************************************************
 // MACROS
 // ************************************************
+#define SORT_SMALL_SIZE     64    // at or below this insertion sort / sorting network, above radix
+#define COUNTING_SORT_MIN   32    // below this a 256 bin histogram costs more than insertion sort
+#define SORT_NETWORK_BLOCK  64    // keys per AVX2 network block, 8 registers of 8 lanes
 
 // ************************************************
 // TYPEDEF & ENUMS
@@ -22,4 +26,19 @@
 // FUNCTION DECLARATIONS
 // ************************************************
 void insertionSort(array_t arr);
-void binaryInsertionSort(array_t array);
\ No newline at end of file
+void binaryInsertionSort(array_t array);
+void countingSort(array_t array);
+// count[v] += occurrences of v in keys[0, size), shared by counting sort and byte selection
+void countBytes(const uint8_t *keys, size_t size, uint64_t *count);
+void sortArray(array_t array);
+
+// algorithm picked by key width at compile time and by size at run time
+void sortKeys(uint8_t *keys, size_t size);
+void sortKeys(uint16_t *keys, size_t size);
+void sortKeys(uint32_t *keys, size_t size);
+void sortKeys(uint64_t *keys, size_t size);
+
+void radixSort(uint16_t *keys, size_t size);
+void radixSort(uint32_t *keys, size_t size);
+void radixSort(uint64_t *keys, size_t size);
+void networkSort(uint32_t *keys, size_t size);
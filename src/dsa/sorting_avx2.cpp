@@ -0,0 +1,158 @@
+// ************************************************
+// PRAGMAS
+// ************************************************
+#pragma once
+
+// ************************************************
+// INCLUDES
+// ************************************************
+#include "sorting.h"
+#include <immintrin.h>
+#include <string.h>
+
+// ************************************************
+// MACROS
+// ************************************************
+
+// ************************************************
+// TYPEDEF & ENUMS
+// ************************************************
+
+// ************************************************
+// FUNCTION DECLARATIONS
+// ************************************************
+// compiled with AVX2 enabled (-mavx2, /arch:AVX2), networkSort() checks the cpu before calling in
+void networkSortBlockAvx2(uint32_t *keys);
+static void mergeSortedRuns(const uint32_t *run1, const uint32_t *run2, size_t size, uint32_t *dst);
+
+// ************************************************
+// FUNCTION DEFINITIONS
+// ************************************************
+static inline void compareExchange(__m256i &a, __m256i &b)
+{
+    __m256i lo = _mm256_min_epu32(a, b);
+    b          = _mm256_max_epu32(a, b);
+    a          = lo;
+}
+
+// 8 key bitonic sequence to ascending order, lanes compared at distance 4, 2, 1
+static inline __m256i bitonicClean(__m256i v)
+{
+    __m256i s = _mm256_permute2x128_si256(v, v, 1);
+    v         = _mm256_blend_epi32(_mm256_min_epu32(v, s), _mm256_max_epu32(v, s), 0xF0);
+    s         = _mm256_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2));
+    v         = _mm256_blend_epi32(_mm256_min_epu32(v, s), _mm256_max_epu32(v, s), 0xCC);
+    s         = _mm256_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1));
+    v         = _mm256_blend_epi32(_mm256_min_epu32(v, s), _mm256_max_epu32(v, s), 0xAA);
+
+    return v;
+}
+
+// two ascending vectors to the lowest 8 keys in a and the highest 8 in b, both ascending
+static inline void bitonicMerge(__m256i &a, __m256i &b)
+{
+    b = _mm256_permutevar8x32_epi32(b, _mm256_set_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+    compareExchange(a, b);
+    a = bitonicClean(a);
+    b = bitonicClean(b);
+}
+
+void networkSortBlockAvx2(uint32_t *keys)
+{
+    __m256i r[8];
+    for (int i = 0; i < 8; i++)
+    {
+        r[i] = _mm256_loadu_si256((const __m256i *)&keys[i * 8]);
+    }
+
+    // 19 comparator network sorts each of the 8 columns
+    compareExchange(r[0], r[2]);
+    compareExchange(r[1], r[3]);
+    compareExchange(r[4], r[6]);
+    compareExchange(r[5], r[7]);
+    compareExchange(r[0], r[4]);
+    compareExchange(r[1], r[5]);
+    compareExchange(r[2], r[6]);
+    compareExchange(r[3], r[7]);
+    compareExchange(r[0], r[1]);
+    compareExchange(r[2], r[3]);
+    compareExchange(r[4], r[5]);
+    compareExchange(r[6], r[7]);
+    compareExchange(r[2], r[4]);
+    compareExchange(r[3], r[5]);
+    compareExchange(r[1], r[4]);
+    compareExchange(r[3], r[6]);
+    compareExchange(r[1], r[2]);
+    compareExchange(r[3], r[4]);
+    compareExchange(r[5], r[6]);
+
+    // transpose so every register holds one sorted run of 8
+    __m256i t[8];
+    for (int i = 0; i < 8; i += 2)
+    {
+        t[i]     = _mm256_unpacklo_epi32(r[i], r[i + 1]);
+        t[i + 1] = _mm256_unpackhi_epi32(r[i], r[i + 1]);
+    }
+    for (int i = 0; i < 8; i += 4)
+    {
+        r[i]     = _mm256_unpacklo_epi64(t[i], t[i + 2]);
+        r[i + 1] = _mm256_unpackhi_epi64(t[i], t[i + 2]);
+        r[i + 2] = _mm256_unpacklo_epi64(t[i + 1], t[i + 3]);
+        r[i + 3] = _mm256_unpackhi_epi64(t[i + 1], t[i + 3]);
+    }
+    for (int i = 0; i < 4; i++)
+    {
+        t[i]     = _mm256_permute2x128_si256(r[i], r[i + 4], 0x20);
+        t[i + 4] = _mm256_permute2x128_si256(r[i], r[i + 4], 0x31);
+    }
+
+    uint32_t buffer[SORT_NETWORK_BLOCK];
+    for (int i = 0; i < 8; i++)
+    {
+        _mm256_storeu_si256((__m256i *)&keys[i * 8], t[i]);
+    }
+
+    // 8 -> 16 -> 32 -> 64, ping-ponging between keys and buffer
+    uint32_t *src = keys;
+    uint32_t *dst = buffer;
+    for (size_t run = 8; run < SORT_NETWORK_BLOCK; run *= 2)
+    {
+        for (size_t start = 0; start < SORT_NETWORK_BLOCK; start += 2 * run)
+        {
+            mergeSortedRuns(&src[start], &src[start + run], run, &dst[start]);
+        }
+        uint32_t *temp = src;
+        src            = dst;
+        dst            = temp;
+    }
+    if (src != keys)
+        memcpy(keys, src, SORT_NETWORK_BLOCK * sizeof(uint32_t));
+}
+
+// two ascending runs of size keys each (multiple of 8), one bitonic merge per 8 keys out
+void mergeSortedRuns(const uint32_t *run1, const uint32_t *run2, size_t size, uint32_t *dst)
+{
+    const uint32_t *end1 = run1 + size;
+    const uint32_t *end2 = run2 + size;
+    __m256i a            = _mm256_loadu_si256((const __m256i *)run1);
+    __m256i b            = _mm256_loadu_si256((const __m256i *)run2);
+    run1 += 8;
+    run2 += 8;
+    bitonicMerge(a, b);
+    _mm256_storeu_si256((__m256i *)dst, a);
+    dst += 8;
+
+    while ((run1 < end1) || (run2 < end2))
+    {
+        bool take1 = (run2 == end2) || ((run1 < end1) && (*run1 <= *run2));
+        a          = _mm256_loadu_si256((const __m256i *)(take1 ? run1 : run2));
+        if (take1)
+            run1 += 8;
+        else
+            run2 += 8;
+        bitonicMerge(a, b);
+        _mm256_storeu_si256((__m256i *)dst, a);
+        dst += 8;
+    }
+    _mm256_storeu_si256((__m256i *)dst, b);
+}
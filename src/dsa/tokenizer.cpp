@@ -0,0 +1,163 @@
+// ************************************************
+// PRAGMAS
+// ************************************************
+#pragma once
+
+// ************************************************
+// INCLUDES
+// ************************************************
+#include "tokenizer.h"
+#include <string.h>
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+    #include <emmintrin.h>
+    #define TOKENIZER_SSE2 1
+#endif
+#ifdef _MSC_VER
+    #include <intrin.h>
+#endif
+
+// ************************************************
+// MACROS
+// ************************************************
+#define TOKENIZER_SCALAR_PREFIX 8
+
+// ************************************************
+// TYPEDEF & ENUMS
+// ************************************************
+
+// ************************************************
+// FUNCTION DECLARATIONS
+// ************************************************
+static uint32_t countTrailingZeros(uint32_t value);
+static const char *scanClass(const tokenizer_t *tokenizer, const char *pos, bool delimiter);
+
+// ************************************************
+// FUNCTION DEFINITIONS
+// ************************************************
+void initTokenizer(tokenizer_t *tokenizer, const char *data, size_t size, const char *delimiters, bool fold_case)
+{
+    tokenizer->cursor    = data;
+    tokenizer->end       = data + size;
+    tokenizer->fold_case = fold_case;
+
+    memset(tokenizer->is_delimiter, 0, sizeof(tokenizer->is_delimiter));
+    size_t num_delimiters = 0;
+    for (const char *c = delimiters; *c; c++)
+    {
+        if (!tokenizer->is_delimiter[(uint8_t)*c])
+        {
+            tokenizer->is_delimiter[(uint8_t)*c] = 1;
+            if (num_delimiters < TOKENIZER_MAX_SIMD_DELIMITERS)
+            {
+                tokenizer->delimiters[num_delimiters] = *c;
+            }
+            num_delimiters++;
+        }
+    }
+
+    tokenizer->num_delimiters = (num_delimiters <= TOKENIZER_MAX_SIMD_DELIMITERS) ? num_delimiters : 0;
+}
+
+bool nextToken(tokenizer_t *tokenizer, token_t *token)
+{
+    const char *start = scanClass(tokenizer, tokenizer->cursor, false);
+    if (start == tokenizer->end)
+    {
+        tokenizer->cursor = start;
+        return false;
+    }
+
+    const char *stop  = scanClass(tokenizer, start, true);
+    token->ptr        = start;
+    token->length     = stop - start;
+    tokenizer->cursor = stop;
+
+    return true;
+}
+
+void foldTokenCase(const token_t *token, char *dst)
+{
+    size_t i = 0;
+#ifdef TOKENIZER_SSE2
+    // 'A'..'Z' -> 'a'..'z' by adding 0x20 where (c - 'A') < 26, via a signed compare trick
+    const __m128i bias  = _mm_set1_epi8((char)(0x80 - 'A'));
+    const __m128i limit = _mm_set1_epi8((char)(0x80 + 25));
+    const __m128i flip  = _mm_set1_epi8(0x20);
+    for (; i + 16 <= token->length; i += 16)
+    {
+        __m128i chunk = _mm_loadu_si128((const __m128i *)(token->ptr + i));
+        __m128i not_upper = _mm_cmpgt_epi8(_mm_add_epi8(chunk, bias), limit);
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_add_epi8(chunk, _mm_andnot_si128(not_upper, flip)));
+    }
+#endif
+    for (; i < token->length; i++)
+    {
+        char c = token->ptr[i];
+        dst[i] = ((c >= 'A') && (c <= 'Z')) ? (char)(c + 0x20) : c;
+    }
+}
+
+// first position at or after pos whose delimiter class equals delimiter, or end
+const char *scanClass(const tokenizer_t *tokenizer, const char *pos, bool delimiter)
+{
+    const char *end = tokenizer->end;
+
+    // natural language tokens are short, settle most of them with table lookups before vectorizing
+    const char *scalar_end = (end - pos > TOKENIZER_SCALAR_PREFIX) ? (pos + TOKENIZER_SCALAR_PREFIX) : end;
+    while (pos < scalar_end)
+    {
+        if ((bool)tokenizer->is_delimiter[(uint8_t)*pos] == delimiter)
+            return pos;
+        pos++;
+    }
+
+#ifdef TOKENIZER_SSE2
+    if (tokenizer->num_delimiters)
+    {
+        __m128i sets[TOKENIZER_MAX_SIMD_DELIMITERS];
+        for (size_t i = 0; i < tokenizer->num_delimiters; i++)
+        {
+            sets[i] = _mm_set1_epi8(tokenizer->delimiters[i]);
+        }
+
+        while (pos + 16 <= end)
+        {
+            __m128i chunk = _mm_loadu_si128((const __m128i *)pos);
+            __m128i hits  = _mm_setzero_si128();
+            for (size_t i = 0; i < tokenizer->num_delimiters; i++)
+            {
+                hits = _mm_or_si128(hits, _mm_cmpeq_epi8(chunk, sets[i]));
+            }
+
+            uint32_t mask = (uint32_t)_mm_movemask_epi8(hits);
+            if (!delimiter)
+            {
+                mask = ~mask & 0xFFFF;
+            }
+            if (mask)
+            {
+                return pos + countTrailingZeros(mask);
+            }
+            pos += 16;
+        }
+    }
+#endif
+
+    while ((pos < end) && ((bool)tokenizer->is_delimiter[(uint8_t)*pos] != delimiter))
+    {
+        pos++;
+    }
+
+    return pos;
+}
+
+uint32_t countTrailingZeros(uint32_t value)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, value);
+    return index;
+#else
+    return __builtin_ctz(value);
+#endif
+}
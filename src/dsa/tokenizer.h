@@ -0,0 +1,44 @@
+// ************************************************
+// PRAGMAS
+// ************************************************
+#pragma once
+
+// ************************************************
+// INCLUDES
+// ************************************************
+#include <stddef.h>
+#include <stdint.h>
+
+// ************************************************
+// MACROS
+// ************************************************
+#define TOKENIZER_DEFAULT_DELIMITERS " ,.-\t\r\n"
+#define TOKENIZER_MAX_SIMD_DELIMITERS 16
+
+// ************************************************
+// TYPEDEF & ENUMS
+// ************************************************
+// view into the tokenized buffer, not NUL terminated
+typedef struct
+{
+    const char *ptr;
+    size_t length;
+} token_t;
+
+// reentrant cursor over a read only buffer, any number of tokenizers can share one buffer
+typedef struct
+{
+    const char *cursor;
+    const char *end;
+    uint8_t is_delimiter[256];
+    char delimiters[TOKENIZER_MAX_SIMD_DELIMITERS];
+    size_t num_delimiters;    // 0 when the set is too large for the vector scan
+    bool fold_case;
+} tokenizer_t;
+
+// ************************************************
+// FUNCTION DECLARATIONS
+// ************************************************
+void initTokenizer(tokenizer_t *tokenizer, const char *data, size_t size, const char *delimiters, bool fold_case);
+bool nextToken(tokenizer_t *tokenizer, token_t *token);
+void foldTokenCase(const token_t *token, char *dst);
@@ -0,0 +1,606 @@
+// ************************************************
+// PRAGMAS
+// ************************************************
+#pragma once
+
+// ************************************************
+// INCLUDES
+// ************************************************
+#include "vector_store.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ************************************************
+// MACROS
+// ************************************************
+#define STORE_ALIGNMENT   8
+#define STORE_MIN_DOCS    64
+#define STORE_MIN_ENTRIES 1024
+
+// ************************************************
+// TYPEDEF & ENUMS
+// ************************************************
+typedef struct
+{
+    uint32_t id;
+    uint32_t count;
+} store_term_t;
+
+// ************************************************
+// FUNCTION DECLARATIONS
+// ************************************************
+static bool writeStore(const char *path, const vocabulary_t *vocabulary, const sparse_vector_t *vectors, size_t num_docs,
+                       uint64_t journal_generation, uint64_t journal_bytes);
+static bool writeSection(FILE *file, const void *data, size_t size, uint64_t *position);
+static bool checkSection(const mapped_file_t *file, uint64_t offset, uint64_t count, size_t size);
+static bool validateStore(const vector_store_t *store);
+static uint64_t alignOffset(uint64_t offset);
+static char *makePath(const char *path, const char *suffix);
+static bool replayJournal(vector_store_t *store);
+static void addNewDocument(vector_store_t *store, store_term_t *terms, size_t num_terms);
+static uint32_t resolveStoreWord(vector_store_t *store, const char *word, size_t length);
+static int compareTerms(const void *lhs, const void *rhs);
+
+// ************************************************
+// FUNCTION DEFINITIONS
+// ************************************************
+bool writeVectorStore(const char *path, const vocabulary_t *vocabulary, const sparse_vector_t *vectors, size_t num_docs)
+{
+    bool ok = writeStore(path, vocabulary, vectors, num_docs, 0, 0);
+
+    // a journal left by an earlier store at this path belongs to that store, not this one
+    if (ok)
+    {
+        char *journal_path = makePath(path, VECTOR_STORE_JOURNAL);
+        remove(journal_path);
+        free(journal_path);
+    }
+
+    return ok;
+}
+
+bool writeStore(const char *path, const vocabulary_t *vocabulary, const sparse_vector_t *vectors, size_t num_docs,
+                uint64_t journal_generation, uint64_t journal_bytes)
+{
+    store_header_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, VECTOR_STORE_MAGIC, sizeof(VECTOR_STORE_MAGIC));
+    header.journal_generation = journal_generation;
+    header.journal_bytes      = journal_bytes;
+    header.num_words          = vocabulary->num_words;
+    header.num_slots          = vocabulary->num_slots;
+    header.num_docs           = num_docs;
+    header.strings_size       = vocabulary->strings_size;
+    for (size_t doc = 0; doc < num_docs; doc++)
+    {
+        header.num_entries += vectors[doc].size;
+    }
+
+    // lay out the sections back to back
+    uint64_t offset            = alignOffset(sizeof(header));
+    header.slots_offset        = offset;
+    offset                     = alignOffset(offset + header.num_slots * sizeof(uint32_t));
+    header.hashes_offset       = offset;
+    offset                     = alignOffset(offset + header.num_words * sizeof(uint64_t));
+    header.word_offsets_offset = offset;
+    offset                     = alignOffset(offset + header.num_words * sizeof(uint64_t));
+    header.lengths_offset      = offset;
+    offset                     = alignOffset(offset + header.num_words * sizeof(uint32_t));
+    header.strings_offset      = offset;
+    offset                     = alignOffset(offset + header.strings_size);
+    header.doc_offsets_offset  = offset;
+    offset                     = alignOffset(offset + (header.num_docs + 1) * sizeof(uint64_t));
+    header.ids_offset          = offset;
+    offset                     = alignOffset(offset + header.num_entries * sizeof(uint32_t));
+    header.counts_offset       = offset;
+    offset                     = alignOffset(offset + header.num_entries * sizeof(uint32_t));
+    header.norms_offset        = offset;
+
+    FILE *file = fopen(path, "wb");
+    if (!file)
+        return false;
+
+    bool ok           = true;
+    uint64_t position = 0;
+    ok &= writeSection(file, &header, sizeof(header), &position);
+    ok &= writeSection(file, vocabulary->slots, header.num_slots * sizeof(uint32_t), &position);
+    ok &= writeSection(file, vocabulary->hashes, header.num_words * sizeof(uint64_t), &position);
+    for (size_t id = 0; id < header.num_words; id++)
+    {
+        uint64_t word_offset = vocabulary->offsets[id];
+        ok &= (fwrite(&word_offset, sizeof(word_offset), 1, file) == 1);
+    }
+    position += header.num_words * sizeof(uint64_t);
+    ok &= writeSection(file, vocabulary->lengths, header.num_words * sizeof(uint32_t), &position);
+    ok &= writeSection(file, vocabulary->strings, header.strings_size, &position);
+
+    uint64_t entries = 0;
+    for (size_t doc = 0; doc <= num_docs; doc++)
+    {
+        ok &= (fwrite(&entries, sizeof(entries), 1, file) == 1);
+        if (doc < num_docs)
+            entries += vectors[doc].size;
+    }
+    position += (num_docs + 1) * sizeof(uint64_t);
+    for (size_t doc = 0; doc < num_docs; doc++)
+    {
+        ok &= writeSection(file, vectors[doc].ids, vectors[doc].size * sizeof(uint32_t), NULL);
+    }
+    position += header.num_entries * sizeof(uint32_t);
+    ok &= writeSection(file, NULL, 0, &position);
+    for (size_t doc = 0; doc < num_docs; doc++)
+    {
+        ok &= writeSection(file, vectors[doc].counts, vectors[doc].size * sizeof(uint32_t), NULL);
+    }
+    position += header.num_entries * sizeof(uint32_t);
+    ok &= writeSection(file, NULL, 0, &position);
+    for (size_t doc = 0; doc < num_docs; doc++)
+    {
+        double norm = computeVectorNorm(&vectors[doc]);
+        ok &= (fwrite(&norm, sizeof(norm), 1, file) == 1);
+    }
+
+    ok &= (fclose(file) == 0);
+
+    return ok;
+}
+
+bool openVectorStore(vector_store_t *store, const char *path)
+{
+    memset(store, 0, sizeof(*store));
+    if (!mapFile(&store->file, path))
+        return false;
+
+    const char *data = store->file.data;
+    if (store->file.size < sizeof(store_header_t) || memcmp(data, VECTOR_STORE_MAGIC, sizeof(VECTOR_STORE_MAGIC)))
+    {
+        unmapFile(&store->file);
+        return false;
+    }
+
+    // no parsing, every section is used in place
+    store->header       = (const store_header_t *)data;
+    store->slots        = (const uint32_t *)(data + store->header->slots_offset);
+    store->hashes       = (const uint64_t *)(data + store->header->hashes_offset);
+    store->word_offsets = (const uint64_t *)(data + store->header->word_offsets_offset);
+    store->lengths      = (const uint32_t *)(data + store->header->lengths_offset);
+    store->strings      = data + store->header->strings_offset;
+    store->doc_offsets  = (const uint64_t *)(data + store->header->doc_offsets_offset);
+    store->ids          = (const uint32_t *)(data + store->header->ids_offset);
+    store->counts       = (const uint32_t *)(data + store->header->counts_offset);
+    store->norms        = (const double *)(data + store->header->norms_offset);
+    if (!validateStore(store))
+    {
+        unmapFile(&store->file);
+        return false;
+    }
+
+    store->path = makePath(path, "");
+    initVocabulary(&store->new_words, 0);
+    store->max_new_docs       = STORE_MIN_DOCS;
+    store->max_new_entries    = STORE_MIN_ENTRIES;
+    store->new_doc_offsets    = (size_t *)malloc((store->max_new_docs + 1) * sizeof(size_t));
+    store->new_ids            = (uint32_t *)malloc(store->max_new_entries * sizeof(uint32_t));
+    store->new_counts         = (uint32_t *)malloc(store->max_new_entries * sizeof(uint32_t));
+    store->new_norms          = (double *)malloc(store->max_new_docs * sizeof(double));
+    if (!store->new_doc_offsets || !store->new_ids || !store->new_counts || !store->new_norms)
+        assert(0);
+    store->new_doc_offsets[0] = 0;
+
+    return replayJournal(store);
+}
+
+void closeVectorStore(vector_store_t *store)
+{
+    unmapFile(&store->file);
+    freeVocabulary(&store->new_words);
+    free(store->new_doc_offsets);
+    free(store->new_ids);
+    free(store->new_counts);
+    free(store->new_norms);
+    free(store->path);
+    memset(store, 0, sizeof(*store));
+}
+
+bool appendStoreDocument(vector_store_t *store, const vocabulary_t *vocabulary, const sparse_vector_t *vector)
+{
+    // journal record: num_terms, then per term word length, word bytes, count
+    char *journal_path = makePath(store->path, VECTOR_STORE_JOURNAL);
+    FILE *journal      = fopen(journal_path, "ab");
+    free(journal_path);
+    if (!journal)
+        return false;
+
+    // a new journal is stamped first, see store_header_t
+    bool ok = (fseek(journal, 0, SEEK_END) == 0);
+    if (ok && ftell(journal) == 0)
+        ok &= (fwrite(&store->journal_generation, sizeof(uint64_t), 1, journal) == 1);
+
+    store_term_t *terms = (store_term_t *)malloc((vector->size + 1) * sizeof(store_term_t));
+    if (!terms)
+        assert(0);
+
+    uint32_t num_terms = (uint32_t)vector->size;
+    ok &= (fwrite(&num_terms, sizeof(num_terms), 1, journal) == 1);
+    for (size_t i = 0; i < vector->size; i++)
+    {
+        size_t length;
+        const char *word  = getWord(vocabulary, vector->ids[i], &length);
+        uint32_t length32 = (uint32_t)length;
+        ok &= (fwrite(&length32, sizeof(length32), 1, journal) == 1);
+        ok &= (fwrite(word, 1, length, journal) == length);
+        ok &= (fwrite(&vector->counts[i], sizeof(uint32_t), 1, journal) == 1);
+
+        terms[i].id    = resolveStoreWord(store, word, length);
+        terms[i].count = vector->counts[i];
+    }
+    long journal_bytes = ftell(journal);
+    ok &= (fclose(journal) == 0) && (journal_bytes > 0);
+
+    if (ok)
+    {
+        store->journal_bytes = (uint64_t)journal_bytes;
+        addNewDocument(store, terms, vector->size);
+    }
+    free(terms);
+
+    return ok;
+}
+
+bool compactVectorStore(vector_store_t *store)
+{
+    // rebuild one vocabulary keeping every id, base words first then appended ones in order
+    size_t num_words = getStoreWordCount(store);
+    size_t num_docs  = getStoreDocumentCount(store);
+
+    vocabulary_t vocabulary;
+    initVocabulary(&vocabulary, num_words);
+    for (uint32_t id = 0; id < num_words; id++)
+    {
+        size_t length;
+        const char *word = getStoreWord(store, id, &length);
+        internWord(&vocabulary, word, length);
+    }
+
+    sparse_vector_t *vectors = (sparse_vector_t *)malloc((num_docs + 1) * sizeof(sparse_vector_t));
+    if (!vectors)
+        assert(0);
+    for (size_t doc = 0; doc < num_docs; doc++)
+    {
+        getStoreDocument(store, doc, &vectors[doc]);
+    }
+
+    // the new file records how much of the journal it holds, so a crash between the rename and
+    // removing the journal does not replay those documents a second time
+    char *path         = makePath(store->path, "");
+    char *tmp_path     = makePath(store->path, ".tmp");
+    char *journal_path = makePath(store->path, VECTOR_STORE_JOURNAL);
+
+    bool ok = writeStore(tmp_path, &vocabulary, vectors, num_docs, store->journal_generation,
+                         store->journal_bytes);
+    free(vectors);
+    freeVocabulary(&vocabulary);
+
+    if (ok)
+    {
+        // the mapping must go before the file can be replaced on every platform
+        closeVectorStore(store);
+#ifdef _WIN32
+        remove(path);    // rename does not replace on windows
+#endif
+        ok = (rename(tmp_path, path) == 0);
+        if (ok)
+            remove(journal_path);
+
+        // a failed rename leaves the original store and journal in place, open that again
+        bool opened = openVectorStore(store, path);
+        ok          = ok && opened;
+    }
+    if (!ok)
+        remove(tmp_path);
+
+    free(path);
+    free(tmp_path);
+    free(journal_path);
+
+    return ok;
+}
+
+size_t getStoreWordCount(const vector_store_t *store)
+{
+    return store->header->num_words + store->new_words.num_words;
+}
+
+size_t getStoreDocumentCount(const vector_store_t *store)
+{
+    return store->header->num_docs + store->num_new_docs;
+}
+
+int64_t findStoreWord(const vector_store_t *store, const char *word, size_t length)
+{
+    if (store->header->num_slots)
+    {
+        uint64_t hash = hashWord(word, length);
+        size_t mask   = store->header->num_slots - 1;
+        for (size_t slot = hash & mask; store->slots[slot] != 0; slot = (slot + 1) & mask)
+        {
+            uint32_t id = store->slots[slot] - 1;
+            if ((store->hashes[id] == hash) && (store->lengths[id] == length) &&
+                !memcmp(&store->strings[store->word_offsets[id]], word, length))
+            {
+                return id;
+            }
+        }
+    }
+
+    int64_t id = findWord(&store->new_words, word, length);
+
+    return (id == WORD_NOT_FOUND) ? WORD_NOT_FOUND : (int64_t)(store->header->num_words + id);
+}
+
+const char *getStoreWord(const vector_store_t *store, uint32_t id, size_t *length)
+{
+    if (id >= store->header->num_words)
+        return getWord(&store->new_words, (uint32_t)(id - store->header->num_words), length);
+
+    if (length)
+        *length = store->lengths[id];
+
+    return &store->strings[store->word_offsets[id]];
+}
+
+void getStoreDocument(const vector_store_t *store, size_t doc, sparse_vector_t *view)
+{
+    // view into the store, must not be passed to freeSparseVector
+    size_t begin, end;
+    const uint32_t *ids, *counts;
+    if (doc < store->header->num_docs)
+    {
+        begin  = store->doc_offsets[doc];
+        end    = store->doc_offsets[doc + 1];
+        ids    = store->ids;
+        counts = store->counts;
+    }
+    else
+    {
+        doc -= store->header->num_docs;
+        assert(doc < store->num_new_docs);
+        begin  = store->new_doc_offsets[doc];
+        end    = store->new_doc_offsets[doc + 1];
+        ids    = store->new_ids;
+        counts = store->new_counts;
+    }
+
+    view->ids    = (uint32_t *)&ids[begin];
+    view->counts = (uint32_t *)&counts[begin];
+    view->size   = end - begin;
+}
+
+double getStoreNorm(const vector_store_t *store, size_t doc)
+{
+    if (doc < store->header->num_docs)
+        return store->norms[doc];
+
+    return store->new_norms[doc - store->header->num_docs];
+}
+
+bool writeSection(FILE *file, const void *data, size_t size, uint64_t *position)
+{
+    // position == NULL continues a section, otherwise pad the section end to the alignment
+    bool ok = (size == 0) || (fwrite(data, 1, size, file) == size);
+    if (position)
+    {
+        static const char zeros[STORE_ALIGNMENT] = {0};
+        *position += size;
+        size_t padding = (size_t)(alignOffset(*position) - *position);
+        ok &= (padding == 0) || (fwrite(zeros, 1, padding, file) == padding);
+        *position += padding;
+    }
+
+    return ok;
+}
+
+bool checkSection(const mapped_file_t *file, uint64_t offset, uint64_t count, size_t size)
+{
+    // count elements of size bytes at offset, aligned and inside the file
+    if (offset % STORE_ALIGNMENT || offset > file->size)
+        return false;
+
+    return count <= (file->size - offset) / size;
+}
+
+bool validateStore(const vector_store_t *store)
+{
+    // the sections are used in place, anything pointing outside the file is rejected here
+    const store_header_t *header = store->header;
+    const mapped_file_t *file    = &store->file;
+    bool ok                      = true;
+    ok &= (header->num_slots & (header->num_slots - 1)) == 0 && header->num_words <= header->num_slots;
+    ok &= header->num_words < UINT32_MAX && header->num_entries < UINT64_MAX / sizeof(uint32_t);
+    ok &= header->num_docs < UINT64_MAX / sizeof(uint64_t);
+    ok &= checkSection(file, header->slots_offset, header->num_slots, sizeof(uint32_t));
+    ok &= checkSection(file, header->hashes_offset, header->num_words, sizeof(uint64_t));
+    ok &= checkSection(file, header->word_offsets_offset, header->num_words, sizeof(uint64_t));
+    ok &= checkSection(file, header->lengths_offset, header->num_words, sizeof(uint32_t));
+    ok &= checkSection(file, header->strings_offset, header->strings_size, sizeof(char));
+    ok &= checkSection(file, header->doc_offsets_offset, header->num_docs + 1, sizeof(uint64_t));
+    ok &= checkSection(file, header->ids_offset, header->num_entries, sizeof(uint32_t));
+    ok &= checkSection(file, header->counts_offset, header->num_entries, sizeof(uint32_t));
+    ok &= checkSection(file, header->norms_offset, header->num_docs, sizeof(double));
+    if (!ok)
+        return false;
+
+    // lookups trust the contents too: slots name words, words lie inside strings, docs inside entries
+    for (size_t slot = 0; ok && slot < header->num_slots; slot++)
+    {
+        ok = (store->slots[slot] <= header->num_words);
+    }
+    for (size_t id = 0; ok && id < header->num_words; id++)
+    {
+        ok = (store->word_offsets[id] <= header->strings_size) &&
+             (store->lengths[id] < header->strings_size - store->word_offsets[id]);
+    }
+    ok = ok && (store->doc_offsets[0] == 0) && (store->doc_offsets[header->num_docs] == header->num_entries);
+    for (size_t doc = 0; ok && doc < header->num_docs; doc++)
+    {
+        ok = (store->doc_offsets[doc] <= store->doc_offsets[doc + 1]);
+    }
+
+    return ok;
+}
+
+uint64_t alignOffset(uint64_t offset)
+{
+    return (offset + STORE_ALIGNMENT - 1) & ~(uint64_t)(STORE_ALIGNMENT - 1);
+}
+
+char *makePath(const char *path, const char *suffix)
+{
+    char *joined = (char *)malloc(strlen(path) + strlen(suffix) + 1);
+    if (!joined)
+        assert(0);
+    strcpy(joined, path);
+    strcat(joined, suffix);
+
+    return joined;
+}
+
+bool replayJournal(vector_store_t *store)
+{
+    char *journal_path = makePath(store->path, VECTOR_STORE_JOURNAL);
+    FILE *journal      = fopen(journal_path, "rb");
+
+    store->journal_generation = store->header->journal_generation + 1;
+    store->journal_bytes      = 0;
+    if (!journal)
+    {
+        free(journal_path);
+        return true;    // nothing appended since the last compaction
+    }
+
+    // a journal without its generation was cut off while being created and holds no records
+    uint64_t generation;
+    if (fread(&generation, sizeof(generation), 1, journal) != 1)
+    {
+        fclose(journal);
+        remove(journal_path);
+        free(journal_path);
+        return true;
+    }
+    free(journal_path);
+
+    // the journal this store was compacted from, skip what the store already holds
+    store->journal_generation = generation;
+    store->journal_bytes      = sizeof(generation);
+    if (generation == store->header->journal_generation && store->header->journal_bytes > sizeof(generation))
+    {
+        if (fseek(journal, (long)store->header->journal_bytes, SEEK_SET) == 0)
+            store->journal_bytes = store->header->journal_bytes;
+    }
+
+    bool ok             = true;
+    size_t max_terms    = STORE_MIN_ENTRIES;
+    size_t max_word     = STORE_MIN_ENTRIES;
+    store_term_t *terms = (store_term_t *)malloc(max_terms * sizeof(store_term_t));
+    char *word          = (char *)malloc(max_word);
+    if (!terms || !word)
+        assert(0);
+
+    uint32_t num_terms;
+    while (fread(&num_terms, sizeof(num_terms), 1, journal) == 1)
+    {
+        if (num_terms > max_terms)
+        {
+            max_terms = num_terms;
+            terms     = (store_term_t *)realloc(terms, max_terms * sizeof(store_term_t));
+            if (!terms)
+                assert(0);
+        }
+
+        for (uint32_t i = 0; ok && i < num_terms; i++)
+        {
+            uint32_t length;
+            ok &= (fread(&length, sizeof(length), 1, journal) == 1);
+            if (ok && length > max_word)
+            {
+                max_word = length;
+                word     = (char *)realloc(word, max_word);
+                if (!word)
+                    assert(0);
+            }
+            ok = ok && (fread(word, 1, length, journal) == length);
+            ok = ok && (fread(&terms[i].count, sizeof(uint32_t), 1, journal) == 1);
+            if (ok)
+                terms[i].id = resolveStoreWord(store, word, length);
+        }
+
+        // a torn last record from an interrupted append is dropped
+        if (!ok)
+            break;
+        addNewDocument(store, terms, num_terms);
+        store->journal_bytes = (uint64_t)ftell(journal);
+    }
+
+    fclose(journal);
+    free(terms);
+    free(word);
+
+    return true;
+}
+
+void addNewDocument(vector_store_t *store, store_term_t *terms, size_t num_terms)
+{
+    if (store->num_new_docs == store->max_new_docs)
+    {
+        store->max_new_docs *= 2;
+        store->new_doc_offsets = (size_t *)realloc(store->new_doc_offsets, (store->max_new_docs + 1) * sizeof(size_t));
+        store->new_norms       = (double *)realloc(store->new_norms, store->max_new_docs * sizeof(double));
+        if (!store->new_doc_offsets || !store->new_norms)
+            assert(0);
+    }
+    while (store->num_new_entries + num_terms > store->max_new_entries)
+    {
+        store->max_new_entries *= 2;
+        store->new_ids    = (uint32_t *)realloc(store->new_ids, store->max_new_entries * sizeof(uint32_t));
+        store->new_counts = (uint32_t *)realloc(store->new_counts, store->max_new_entries * sizeof(uint32_t));
+        if (!store->new_ids || !store->new_counts)
+            assert(0);
+    }
+
+    // store ids differ from the source vocabulary's, restore ascending order
+    qsort(terms, num_terms, sizeof(store_term_t), compareTerms);
+
+    sparse_vector_t view;
+    view.ids    = &store->new_ids[store->num_new_entries];
+    view.counts = &store->new_counts[store->num_new_entries];
+    view.size   = num_terms;
+    for (size_t i = 0; i < num_terms; i++)
+    {
+        view.ids[i]    = terms[i].id;
+        view.counts[i] = terms[i].count;
+    }
+
+    store->num_new_entries += num_terms;
+    store->new_norms[store->num_new_docs] = computeVectorNorm(&view);
+    store->num_new_docs++;
+    store->new_doc_offsets[store->num_new_docs] = store->num_new_entries;
+}
+
+uint32_t resolveStoreWord(vector_store_t *store, const char *word, size_t length)
+{
+    int64_t id = findStoreWord(store, word, length);
+    if (id != WORD_NOT_FOUND)
+        return (uint32_t)id;
+
+    return (uint32_t)(store->header->num_words + internWord(&store->new_words, word, length));
+}
+
+int compareTerms(const void *lhs, const void *rhs)
+{
+    uint32_t id1 = ((const store_term_t *)lhs)->id;
+    uint32_t id2 = ((const store_term_t *)rhs)->id;
+
+    return (id1 > id2) - (id1 < id2);
+}
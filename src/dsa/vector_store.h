@@ -0,0 +1,91 @@
+// ************************************************
+// PRAGMAS
+// ************************************************
+#pragma once
+
+// ************************************************
+// INCLUDES
+// ************************************************
+#include <stddef.h>
+#include <stdint.h>
+
+#include "document_distance.h"
+#include "mapped_file.h"
+
+// ************************************************
+// MACROS
+// ************************************************
+#define VECTOR_STORE_MAGIC   "DOCVEC2"
+#define VECTOR_STORE_JOURNAL ".journal"
+
+// ************************************************
+// TYPEDEF & ENUMS
+// ************************************************
+// on disk layout, every section starts 8 byte aligned at the given file offset. the journal
+// starts with its uint64_t generation; the first journal_bytes of the journal with generation
+// journal_generation are already folded into this file and are skipped on replay
+typedef struct
+{
+    char magic[8];
+    uint64_t journal_generation;
+    uint64_t journal_bytes;
+    uint64_t num_words;
+    uint64_t num_slots;
+    uint64_t num_docs;
+    uint64_t num_entries;
+    uint64_t strings_size;
+    uint64_t slots_offset;           // uint32_t[num_slots], word id + 1, same probing as vocabulary_t
+    uint64_t hashes_offset;          // uint64_t[num_words]
+    uint64_t word_offsets_offset;    // uint64_t[num_words], into strings
+    uint64_t lengths_offset;         // uint32_t[num_words]
+    uint64_t strings_offset;         // char[strings_size], NUL terminated words
+    uint64_t doc_offsets_offset;     // uint64_t[num_docs + 1], into ids / counts
+    uint64_t ids_offset;             // uint32_t[num_entries]
+    uint64_t counts_offset;          // uint32_t[num_entries]
+    uint64_t norms_offset;           // double[num_docs]
+} store_header_t;
+
+// compacted base is used straight from the mapping, documents appended since then live in memory
+typedef struct
+{
+    char *path;
+    mapped_file_t file;
+    uint64_t journal_generation;    // of the journal appends go to
+    uint64_t journal_bytes;         // journal prefix held by the store, base and new documents
+    const store_header_t *header;
+    const uint32_t *slots;
+    const uint64_t *hashes;
+    const uint64_t *word_offsets;
+    const uint32_t *lengths;
+    const char *strings;
+    const uint64_t *doc_offsets;
+    const uint32_t *ids;
+    const uint32_t *counts;
+    const double *norms;
+
+    vocabulary_t new_words;    // ids continue after header->num_words
+    size_t num_new_docs;
+    size_t max_new_docs;
+    size_t num_new_entries;
+    size_t max_new_entries;
+    size_t *new_doc_offsets;
+    uint32_t *new_ids;
+    uint32_t *new_counts;
+    double *new_norms;
+} vector_store_t;
+
+// ************************************************
+// FUNCTION DECLARATIONS
+// ************************************************
+bool writeVectorStore(const char *path, const vocabulary_t *vocabulary, const sparse_vector_t *vectors, size_t num_docs);
+bool openVectorStore(vector_store_t *store, const char *path);
+void closeVectorStore(vector_store_t *store);
+bool appendStoreDocument(vector_store_t *store, const vocabulary_t *vocabulary, const sparse_vector_t *vector);
+bool compactVectorStore(vector_store_t *store);
+
+size_t getStoreWordCount(const vector_store_t *store);
+size_t getStoreDocumentCount(const vector_store_t *store);
+int64_t findStoreWord(const vector_store_t *store, const char *word, size_t length);
+const char *getStoreWord(const vector_store_t *store, uint32_t id, size_t *length);
+void getStoreDocument(const vector_store_t *store, size_t doc, sparse_vector_t *view);
+double getStoreNorm(const vector_store_t *store, size_t doc);
@@ -0,0 +1,163 @@
+// ************************************************
+// PRAGMAS
+// ************************************************
+#pragma once
+
+// ************************************************
+// INCLUDES
+// ************************************************
+#include "work_stealing.h"
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// ************************************************
+// MACROS
+// ************************************************
+
+// ************************************************
+// TYPEDEF & ENUMS
+// ************************************************
+// remaining items of one worker, the owner takes from the front and thieves take from the back
+typedef struct
+{
+    std::mutex lock;
+    size_t begin;
+    size_t end;
+} work_range_t;
+
+typedef struct
+{
+    work_range_t *ranges;
+    unsigned num_threads;
+    size_t grain;
+    range_func_t func;
+    void *context;
+} work_pool_t;
+
+// ************************************************
+// FUNCTION DECLARATIONS
+// ************************************************
+static bool takeFront(work_range_t *range, size_t grain, size_t *begin, size_t *end);
+static bool stealBack(work_pool_t *pool, unsigned thief);
+static void runWorker(work_pool_t *pool, unsigned worker);
+
+// ************************************************
+// FUNCTION DEFINITIONS
+// ************************************************
+unsigned resolveThreadCount(unsigned num_threads)
+{
+    if (num_threads == 0)
+    {
+        num_threads = std::thread::hardware_concurrency();
+    }
+
+    return (num_threads == 0) ? 1 : num_threads;
+}
+
+void parallelFor(size_t count, size_t grain, range_func_t func, void *context, unsigned num_threads)
+{
+    num_threads = resolveThreadCount(num_threads);
+    if (grain == 0)
+    {
+        grain = 1;
+    }
+
+    if ((num_threads == 1) || (count <= grain))
+    {
+        if (count)
+            func(0, count, 0, context);
+        return;
+    }
+
+    // each worker starts with an equal slice
+    std::vector<work_range_t> ranges(num_threads);
+    for (unsigned i = 0; i < num_threads; i++)
+    {
+        ranges[i].begin = count * i / num_threads;
+        ranges[i].end   = count * (i + 1) / num_threads;
+    }
+
+    work_pool_t pool = {ranges.data(), num_threads, grain, func, context};
+
+    std::vector<std::thread> threads;
+    for (unsigned i = 1; i < num_threads; i++)
+    {
+        threads.push_back(std::thread(runWorker, &pool, i));
+    }
+    runWorker(&pool, 0);
+
+    for (size_t i = 0; i < threads.size(); i++)
+    {
+        threads[i].join();
+    }
+}
+
+bool takeFront(work_range_t *range, size_t grain, size_t *begin, size_t *end)
+{
+    std::lock_guard<std::mutex> guard(range->lock);
+    if (range->begin >= range->end)
+        return false;
+
+    *begin       = range->begin;
+    *end         = (range->end - range->begin > grain) ? (range->begin + grain) : range->end;
+    range->begin = *end;
+
+    return true;
+}
+
+bool stealBack(work_pool_t *pool, unsigned thief)
+{
+    // pick the victim with the most work left, then re-check under its lock
+    unsigned victim  = thief;
+    size_t most_left = 0;
+    for (unsigned i = 0; i < pool->num_threads; i++)
+    {
+        if (i == thief)
+            continue;
+
+        std::lock_guard<std::mutex> guard(pool->ranges[i].lock);
+        size_t left = pool->ranges[i].end - pool->ranges[i].begin;
+        if (left > most_left)
+        {
+            most_left = left;
+            victim    = i;
+        }
+    }
+    if (victim == thief)
+        return false;
+
+    size_t begin, end;
+    {
+        std::lock_guard<std::mutex> guard(pool->ranges[victim].lock);
+        work_range_t *range = &pool->ranges[victim];
+        if (range->begin >= range->end)
+            return true;    // raced with the owner, look again
+
+        size_t half = (range->end - range->begin + 1) / 2;
+        begin       = range->end - half;
+        end         = range->end;
+        range->end  = begin;
+    }
+
+    std::lock_guard<std::mutex> guard(pool->ranges[thief].lock);
+    pool->ranges[thief].begin = begin;
+    pool->ranges[thief].end   = end;
+
+    return true;
+}
+
+void runWorker(work_pool_t *pool, unsigned worker)
+{
+    size_t begin, end;
+    while (1)
+    {
+        while (takeFront(&pool->ranges[worker], pool->grain, &begin, &end))
+        {
+            pool->func(begin, end, worker, pool->context);
+        }
+
+        if (!stealBack(pool, worker))
+            break;
+    }
+}
@@ -0,0 +1,26 @@
+// ************************************************
+// PRAGMAS
+// ************************************************
+#pragma once
+
+// ************************************************
+// INCLUDES
+// ************************************************
+#include <stddef.h>
+#include <stdint.h>
+
+// ************************************************
+// MACROS
+// ************************************************
+
+// ************************************************
+// TYPEDEF & ENUMS
+// ************************************************
+// processes items [begin, end), worker is in [0, num_threads) and can index per thread scratch
+typedef void (*range_func_t)(size_t begin, size_t end, unsigned worker, void *context);
+
+// ************************************************
+// FUNCTION DECLARATIONS
+// ************************************************
+unsigned resolveThreadCount(unsigned num_threads);
+void parallelFor(size_t count, size_t grain, range_func_t func, void *context, unsigned num_threads);
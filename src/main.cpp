@@ -1,11 +1,46 @@
 #include <iostream>
+#ifdef _WIN32
+    #include <fcntl.h>
+    #include <io.h>
+#endif
 
 #include "blur.hpp"
+#include "cache.hpp"
+#include "color.hpp"
 #include "edge.hpp"
 #include "histogram.hpp"
 #include "ocl.hpp"
 #include "pgm.hpp"
 #include "resize.hpp"
+#include "stream.hpp"
+
+// ./main_exe --stream < frames.pgm > edges.pgm
+int stream_main()
+{
+#ifdef _WIN32
+    _setmode(_fileno(stdin), _O_BINARY);
+    _setmode(_fileno(stdout), _O_BINARY);
+#endif
+
+    // intermediates live across frames and are only reallocated when the frame size changes
+    pgm_t blur_pgm(0, 0);
+    pgm_t edgeX_pgm(0, 0);
+    pgm_t edgeY_pgm(0, 0);
+
+    run_stream(stdin, stdout, [&](pgm_t &src_pgm, pgm_t &dst_pgm) {
+        blur_pgm.reshape(src_pgm.width(), src_pgm.height());
+        edgeX_pgm.reshape(src_pgm.width(), src_pgm.height());
+        edgeY_pgm.reshape(src_pgm.width(), src_pgm.height());
+        dst_pgm.reshape(src_pgm.width(), src_pgm.height());
+
+        blur(src_pgm, blur_pgm, clamp);
+        edgeX(blur_pgm, edgeX_pgm, clamp);
+        edgeY(blur_pgm, edgeY_pgm, clamp);
+        edgeRmsAuto(edgeX_pgm, edgeY_pgm, dst_pgm, triangle);
+    });
+
+    return 0;
+}
 
 int main(int argc, char const *argv[])
 {
@@ -13,31 +48,58 @@ int main(int argc, char const *argv[])
     assert(argc == 2);
     std::string input_filename = std::string(argv[1]);
 
-    pgm_t src_pgm(input_filename);
+    if (input_filename == "--stream")
+    {
+        return stream_main();
+    }
+
+    // P5 or P6, colour input is converted with the weights input/lenna.pgm was made with
+    pgm_t src_pgm(0, 0);
+    bool loaded = read_gray(input_filename, src_pgm, bt709);
+    assert(loaded);
     src_pgm.write("./1_input.pgm");
-    histogram(src_pgm);
+
+    // CV_CACHE_DIR keeps every stage output on disk; keys chain from the input pixels through
+    // each stage's parameters, so a rerun only recomputes stages downstream of a change
+    const char *cache_dir = getenv("CV_CACHE_DIR");
+    stage_cache_t cache((cache_dir != NULL) ? cache_dir : "", CACHE_MAX_BYTES);
+    uint64_t src_key = image_key(src_pgm);
+
+    uint64_t hist_key = stage_key(src_key, "histogram");
+    cache.run(hist_key, src_pgm, [&]() { histogram(src_pgm); });
     src_pgm.write("./2_histogram_equalized.pgm");
 
     pgm_t blur_pgm(src_pgm.width(), src_pgm.height());
-
-    blur(src_pgm, blur_pgm, clamp);
+    uint64_t blur_key = kernel_key(cache_mix(stage_key(hist_key, "blur"), clamp), blur_kernel, 3, blur_div_factor);
+    cache.run(blur_key, blur_pgm, [&]() { blur(src_pgm, blur_pgm, clamp); });
     blur_pgm.write("./3_blured.pgm");
 
+    uint64_t edgeX_key = kernel_key(cache_mix(stage_key(hist_key, "edgeX"), clamp), edge_x_kernel, 3, edge_div_factor);
     pgm_t edgeX_pgm(src_pgm.width(), src_pgm.height());
-    edgeX(src_pgm, edgeX_pgm, clamp);
+    cache.run(edgeX_key, edgeX_pgm, [&]() { edgeX(src_pgm, edgeX_pgm, clamp); });
     edgeX_pgm.write("./4_edgeX.pgm");
 
+    uint64_t edgeY_key = kernel_key(cache_mix(stage_key(hist_key, "edgeY"), clamp), edge_y_kernel, 3, edge_div_factor);
     pgm_t edgeY_pgm(src_pgm.width(), src_pgm.height());
-    edgeY(src_pgm, edgeY_pgm, clamp);
+    cache.run(edgeY_key, edgeY_pgm, [&]() { edgeY(src_pgm, edgeY_pgm, clamp); });
     edgeY_pgm.write("./5_edgeY.pgm");
 
     pgm_t dst_pgm(src_pgm.width(), src_pgm.height());
-    edgeRms(edgeX_pgm, edgeY_pgm, dst_pgm, 0);
+    cache.run(cache_mix(stage_key(cache_mix(edgeX_key, edgeY_key), "edgeRmsAuto"), triangle), dst_pgm,
+              [&]() { edgeRmsAuto(edgeX_pgm, edgeY_pgm, dst_pgm, triangle); });
     dst_pgm.write("./6_edgeRMS.pgm");
 
 	pgm_t rsz_pgm(1024, 1024);
-    resize(src_pgm, rsz_pgm, bilinear);
+    uint64_t rsz_key = cache_mix(stage_key(hist_key, "resize"), bilinear);
+    rsz_key = cache_mix(cache_mix(rsz_key, rsz_pgm.width()), rsz_pgm.height());
+    cache.run(rsz_key, rsz_pgm, [&]() { resize(src_pgm, rsz_pgm, bilinear); });
     rsz_pgm.write("./7_resize.pgm");
+
+    if (cache_dir != NULL)
+    {
+        std::cerr << "cache: " << cache.hits() << " hits, " << cache.misses() << " misses, " << cache.evictions()
+                  << " evictions, " << cache.bytes() << " bytes" << std::endl;
+    }
 #else
     matrix_multiplication(); //FIXME: not working
 #endif